@@ -0,0 +1,259 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "Capture.h"
+#include "Clock.h"
+#include "Log.h"
+
+#include <cassert>
+#include <cstring>
+
+const unsigned int MAX_RECORD_LENGTH = 65535U;
+
+static CCapture* m_capture = nullptr;
+
+static unsigned int encodeVarint(unsigned char* p, unsigned long long value)
+{
+	unsigned int n = 0U;
+
+	while (value >= 0x80U) {
+		p[n++] = (unsigned char)(value | 0x80U);
+		value >>= 7;
+	}
+
+	p[n++] = (unsigned char)value;
+
+	return n;
+}
+
+CCapture::CCapture(const std::string& fileName) :
+m_fileName(fileName),
+m_fp(nullptr),
+m_last(0ULL),
+m_mutex()
+{
+	assert(!fileName.empty());
+}
+
+CCapture::~CCapture()
+{
+}
+
+bool CCapture::open()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	m_fp = ::fopen(m_fileName.c_str(), "wb");
+	if (m_fp == nullptr) {
+		LogError("Cannot create the capture file %s", m_fileName.c_str());
+		return false;
+	}
+
+	unsigned long long start = CClock::get().wall();
+	m_last = CClock::get().monotonic() / 1000ULL;
+
+	unsigned char header[CAPTURE_HEADER_LENGTH];
+	::memset(header, 0x00U, CAPTURE_HEADER_LENGTH);
+	::memcpy(header, CAPTURE_MAGIC, 8U);
+
+	for (unsigned int i = 0U; i < 4U; i++)
+		header[8U + i] = (unsigned char)(CAPTURE_VERSION >> (i * 8U));
+	for (unsigned int i = 0U; i < 8U; i++)
+		header[16U + i] = (unsigned char)(start >> (i * 8U));
+
+	if (::fwrite(header, 1U, CAPTURE_HEADER_LENGTH, m_fp) != CAPTURE_HEADER_LENGTH) {
+		LogError("Cannot write to the capture file %s", m_fileName.c_str());
+		::fclose(m_fp);
+		m_fp = nullptr;
+		return false;
+	}
+
+	LogMessage("Capturing the DAPNET and MMDVM traffic to %s", m_fileName.c_str());
+
+	return true;
+}
+
+void CCapture::write(CAPTURE_TYPE type, const unsigned char* data, unsigned int length)
+{
+	if (length > MAX_RECORD_LENGTH)
+		length = MAX_RECORD_LENGTH;
+
+	assert(data != nullptr || length == 0U);
+
+	unsigned long long now = CClock::get().monotonic() / 1000ULL;
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (m_fp == nullptr)
+		return;
+
+	unsigned char prefix[25U];
+	unsigned int n = 0U;
+	prefix[n++] = (unsigned char)type;
+	n += encodeVarint(prefix + n, now - m_last);
+	n += encodeVarint(prefix + n, length);
+
+	m_last = now;
+
+	::fwrite(prefix, 1U, n, m_fp);
+	if (length > 0U)
+		::fwrite(data, 1U, length, m_fp);
+
+	// The traffic is light, and a capture of an incident should survive a crash
+	::fflush(m_fp);
+}
+
+void CCapture::close()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (m_fp != nullptr) {
+		::fclose(m_fp);
+		m_fp = nullptr;
+	}
+}
+
+CCaptureReader::CCaptureReader(const std::string& fileName) :
+m_fileName(fileName),
+m_fp(nullptr),
+m_start(0ULL),
+m_time(0ULL)
+{
+	assert(!fileName.empty());
+}
+
+CCaptureReader::~CCaptureReader()
+{
+}
+
+bool CCaptureReader::open()
+{
+	m_fp = ::fopen(m_fileName.c_str(), "rb");
+	if (m_fp == nullptr)
+		return false;
+
+	unsigned char header[CAPTURE_HEADER_LENGTH];
+	if (::fread(header, 1U, CAPTURE_HEADER_LENGTH, m_fp) != CAPTURE_HEADER_LENGTH || ::memcmp(header, CAPTURE_MAGIC, 8U) != 0) {
+		close();
+		return false;
+	}
+
+	unsigned int version = 0U;
+	for (unsigned int i = 0U; i < 4U; i++)
+		version |= (unsigned int)header[8U + i] << (i * 8U);
+
+	if (version != CAPTURE_VERSION) {
+		close();
+		return false;
+	}
+
+	m_start = 0ULL;
+	for (unsigned int i = 0U; i < 8U; i++)
+		m_start |= (unsigned long long)header[16U + i] << (i * 8U);
+
+	m_time = 0ULL;
+
+	return true;
+}
+
+unsigned long long CCaptureReader::getStart() const
+{
+	return m_start;
+}
+
+bool CCaptureReader::read(CCaptureRecord& record)
+{
+	if (m_fp == nullptr)
+		return false;
+
+	int type = ::fgetc(m_fp);
+	if (type == EOF)
+		return false;
+
+	unsigned long long delta, length;
+	if (!readVarint(delta) || !readVarint(length) || length > MAX_RECORD_LENGTH)
+		return false;
+
+	m_time += delta;
+
+	record.m_type = CAPTURE_TYPE(type);
+	record.m_time = m_time;
+	record.m_data.resize((size_t)length);
+
+	if (length > 0U && ::fread(record.m_data.data(), 1U, (size_t)length, m_fp) != length)
+		return false;
+
+	return true;
+}
+
+void CCaptureReader::close()
+{
+	if (m_fp != nullptr) {
+		::fclose(m_fp);
+		m_fp = nullptr;
+	}
+}
+
+bool CCaptureReader::readVarint(unsigned long long& value)
+{
+	value = 0ULL;
+
+	for (unsigned int shift = 0U; shift < 64U; shift += 7U) {
+		int c = ::fgetc(m_fp);
+		if (c == EOF)
+			return false;
+
+		value |= (unsigned long long)(c & 0x7F) << shift;
+		if ((c & 0x80) == 0)
+			return true;
+	}
+
+	return false;
+}
+
+bool CaptureInitialise(const std::string& fileName)
+{
+	CaptureFinalise();
+
+	CCapture* capture = new CCapture(fileName);
+
+	bool ret = capture->open();
+	if (!ret) {
+		delete capture;
+		return false;
+	}
+
+	m_capture = capture;
+
+	return true;
+}
+
+void CaptureFinalise()
+{
+	if (m_capture != nullptr) {
+		m_capture->close();
+		delete m_capture;
+		m_capture = nullptr;
+	}
+}
+
+void CaptureFrame(CAPTURE_TYPE type, const unsigned char* data, unsigned int length)
+{
+	if (m_capture != nullptr)
+		m_capture->write(type, data, length);
+}
@@ -0,0 +1,97 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(CAPTURE_H)
+#define	CAPTURE_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+
+#include <cstdio>
+
+const char CAPTURE_MAGIC[] = "DAPNETCP";
+
+const unsigned int CAPTURE_VERSION       = 1U;
+const unsigned int CAPTURE_HEADER_LENGTH = 24U;
+
+enum class CAPTURE_TYPE : unsigned char {
+	NONE,
+	DAPNET_RX,		// The bytes of one read from the DAPNET socket
+	DAPNET_LOST,		// The DAPNET connection failed
+	MMDVM_RX		// The status bytes from the MMDVM
+};
+
+// A record read back from a capture, the time is in microseconds from the start
+struct CCaptureRecord {
+	CAPTURE_TYPE               m_type;
+	unsigned long long         m_time;
+	std::vector<unsigned char> m_data;
+};
+
+// The file starts with the magic, the version and the wall clock time in
+// nanoseconds at the start, as little endian 32 and 64 bit values. Each
+// record is then a type byte, the microseconds since the previous record
+// and the data length as base 128 varints, and the data.
+class CCapture {
+public:
+	CCapture(const std::string& fileName);
+	~CCapture();
+
+	bool open();
+
+	void write(CAPTURE_TYPE type, const unsigned char* data, unsigned int length);
+
+	void close();
+
+private:
+	std::string        m_fileName;
+	FILE*              m_fp;
+	unsigned long long m_last;
+	std::mutex         m_mutex;
+};
+
+class CCaptureReader {
+public:
+	CCaptureReader(const std::string& fileName);
+	~CCaptureReader();
+
+	bool open();
+
+	// The wall clock time of the start of the capture, in nanoseconds
+	unsigned long long getStart() const;
+
+	bool read(CCaptureRecord& record);
+
+	void close();
+
+private:
+	std::string        m_fileName;
+	FILE*              m_fp;
+	unsigned long long m_start;
+	unsigned long long m_time;
+
+	bool readVarint(unsigned long long& value);
+};
+
+extern bool CaptureInitialise(const std::string& fileName);
+extern void CaptureFinalise();
+
+extern void CaptureFrame(CAPTURE_TYPE type, const unsigned char* data, unsigned int length);
+
+#endif
@@ -0,0 +1,143 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "Clock.h"
+
+#if defined(_WIN32) || defined(_WIN64)
+#define _WINSOCKAPI_
+#include <WS2tcpip.h>
+#include <windows.h>
+#else
+#include <ctime>
+#endif
+
+static CSystemClock systemClock;
+
+CClock* CClock::m_clock = &systemClock;
+
+CClock::~CClock()
+{
+}
+
+void CClock::set(CClock* clock)
+{
+	m_clock = clock != nullptr ? clock : &systemClock;
+}
+
+CSystemClock::CSystemClock()
+{
+}
+
+CSystemClock::~CSystemClock()
+{
+}
+
+#if defined(_WIN32) || defined(_WIN64)
+
+unsigned long long CSystemClock::monotonic() const
+{
+	LARGE_INTEGER frequency, now;
+	::QueryPerformanceFrequency(&frequency);
+	::QueryPerformanceCounter(&now);
+
+	return (unsigned long long)((now.QuadPart / frequency.QuadPart) * 1000000000LL + ((now.QuadPart % frequency.QuadPart) * 1000000000LL) / frequency.QuadPart);
+}
+
+unsigned long long CSystemClock::wall() const
+{
+	FILETIME ft;
+	::GetSystemTimeAsFileTime(&ft);
+
+	ULARGE_INTEGER time;
+	time.LowPart  = ft.dwLowDateTime;
+	time.HighPart = ft.dwHighDateTime;
+
+	// From 100 ns since 1601 to ns since 1970
+	return (time.QuadPart - 116444736000000000ULL) * 100ULL;
+}
+
+void CSystemClock::sleepUntil(unsigned long long monotonic)
+{
+	unsigned long long now = this->monotonic();
+	if (monotonic <= now)
+		return;
+
+	::Sleep(DWORD((monotonic - now + 999999ULL) / 1000000ULL));
+}
+
+#else
+
+unsigned long long CSystemClock::monotonic() const
+{
+	struct timespec now;
+	::clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+unsigned long long CSystemClock::wall() const
+{
+	struct timespec now;
+	::clock_gettime(CLOCK_REALTIME, &now);
+
+	return now.tv_sec * 1000000000ULL + now.tv_nsec;
+}
+
+void CSystemClock::sleepUntil(unsigned long long monotonic)
+{
+	struct timespec ts;
+	ts.tv_sec  = time_t(monotonic / 1000000000ULL);
+	ts.tv_nsec = long(monotonic % 1000000000ULL);
+
+	// A signal ends the sleep early, as with CThread::sleep()
+	::clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, nullptr);
+}
+
+#endif
+
+CVirtualClock::CVirtualClock(unsigned long long wall) :
+m_monotonic(1000000000ULL),
+m_wall(wall - 1000000000ULL)
+{
+}
+
+CVirtualClock::~CVirtualClock()
+{
+}
+
+unsigned long long CVirtualClock::monotonic() const
+{
+	return m_monotonic.load(std::memory_order_relaxed);
+}
+
+unsigned long long CVirtualClock::wall() const
+{
+	return m_wall + m_monotonic.load(std::memory_order_relaxed);
+}
+
+void CVirtualClock::sleepUntil(unsigned long long monotonic)
+{
+	unsigned long long now = m_monotonic.load(std::memory_order_relaxed);
+	while (monotonic > now && !m_monotonic.compare_exchange_weak(now, monotonic, std::memory_order_relaxed))
+		;
+}
+
+void CVirtualClock::advance(unsigned long long ns)
+{
+	m_monotonic.fetch_add(ns, std::memory_order_relaxed);
+}
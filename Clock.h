@@ -0,0 +1,86 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(CLOCK_H)
+#define	CLOCK_H
+
+#include <atomic>
+
+// The source of time for the gateway. CStopWatch, and so every CTimer that is
+// clocked from one, CSlotClock and the main loop's sleeps all go through the
+// current clock, which is the system clock unless another has been set. The
+// virtual clock only moves when it is told to, or when something sleeps on
+// it, so hours of the gateway can be run in seconds. All times are in ns.
+class CClock {
+public:
+	virtual ~CClock();
+
+	virtual unsigned long long monotonic() const = 0;
+	virtual unsigned long long wall() const = 0;
+
+	// Until the monotonic time given
+	virtual void sleepUntil(unsigned long long monotonic) = 0;
+
+	void sleep(unsigned int ms)
+	{
+		sleepUntil(monotonic() + ms * 1000000ULL);
+	}
+
+	static CClock& get()
+	{
+		return *m_clock;
+	}
+
+	// Not owned, nullptr for the system clock
+	static void set(CClock* clock);
+
+private:
+	static CClock* m_clock;
+};
+
+class CSystemClock : public CClock {
+public:
+	CSystemClock();
+	virtual ~CSystemClock();
+
+	virtual unsigned long long monotonic() const;
+	virtual unsigned long long wall() const;
+
+	virtual void sleepUntil(unsigned long long monotonic);
+};
+
+class CVirtualClock : public CClock {
+public:
+	// Starting at the wall time given, in ns since 1970
+	CVirtualClock(unsigned long long wall);
+	virtual ~CVirtualClock();
+
+	virtual unsigned long long monotonic() const;
+	virtual unsigned long long wall() const;
+
+	// Sleeping moves the clock on to the deadline straight away
+	virtual void sleepUntil(unsigned long long monotonic);
+
+	void advance(unsigned long long ns);
+
+private:
+	std::atomic<unsigned long long> m_monotonic;
+	unsigned long long              m_wall;
+};
+
+#endif
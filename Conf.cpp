@@ -1,5 +1,5 @@
 /*
- *   Copyright (C) 2018,2020,2023,2025 by Jonathan Naylor G4KLX
+ *   Copyright (C) 2018,2020,2023,2025,2026 by Jonathan Naylor G4KLX
  *
  *   This program is free software; you can redistribute it and/or modify
  *   it under the terms of the GNU General Public License as published by
@@ -32,7 +32,18 @@ enum class SECTION {
 	GENERAL,
 	LOG,
 	MQTT,
-	DAPNET
+	DAPNET,
+	EVENTLOG,
+	INJECTION,
+	SPOOL,
+	STATISTICS,
+	METRICS,
+	STATSPAGE,
+	PROFILER,
+	TRACE,
+	WATCHDOG,
+	REALTIME,
+	CAPTURE
 };
 
 CConf::CConf(const std::string& file) :
@@ -55,10 +66,55 @@ m_mqttName("dapnet-gateway"),
 m_mqttAuthEnabled(false),
 m_mqttUsername(),
 m_mqttPassword(),
+m_mqttBatchTime(0U),
+m_mqttBatchSize(4096U),
+m_mqttBufferSize(1000U),
+m_mqttReplayRate(100U),
+m_mqttMessageEvents(false),
 m_dapnetAddress(),
 m_dapnetPort(0U),
 m_dapnetAuthKey(),
-m_dapnetDebug(false)
+m_dapnetDebug(false),
+m_dapnetHealthInterval(5U),
+m_dapnetMaxRTT(0U),
+m_dapnetMaxRetransmits(0U),
+m_dapnetAckTimeout(0U),
+m_dapnetDegradedSamples(3U),
+m_dapnetTimeSync(false),
+m_eventLogEnabled(false),
+m_eventLogFile("/var/log/mmdvm/DAPNETGateway.evt"),
+m_eventLogSize(1024U),
+m_eventLogFiles(3U),
+m_eventLogFrames(true),
+m_injectionEnabled(false),
+m_injectionRate(50U),
+m_injectionBurst(100U),
+m_injectionQueue(1000U),
+m_spoolEnabled(false),
+m_spoolDirectory("/var/spool/dapnet"),
+m_statisticsInterval(60U),
+m_statisticsSlots(true),
+m_statisticsTopInterval(300U),
+m_statisticsTopCount(10U),
+m_metricsEnabled(false),
+m_metricsAddress("127.0.0.1"),
+m_metricsPort(9110U),
+m_statsPageEnabled(false),
+m_statsPageName("/dapnetgateway"),
+m_profilerEnabled(false),
+m_profilerInterval(60U),
+m_traceEnabled(false),
+m_traceEvents(100000U),
+m_traceDirectory("/tmp"),
+m_watchdogEnabled(false),
+m_watchdogThreshold(2000U),
+m_watchdogSystemd(false),
+m_realTimeEnabled(false),
+m_realTimePriority(50U),
+m_realTimeCPU(-1),
+m_realTimeLockMemory(true),
+m_captureEnabled(false),
+m_captureFile("/tmp/DAPNETGateway.cap")
 {
 }
 
@@ -90,6 +146,28 @@ bool CConf::read()
 				section = SECTION::MQTT;
 			else if (::strncmp(buffer, "[DAPNET]", 8U) == 0)
 				section = SECTION::DAPNET;
+			else if (::strncmp(buffer, "[Event Log]", 11U) == 0)
+				section = SECTION::EVENTLOG;
+			else if (::strncmp(buffer, "[Injection]", 11U) == 0)
+				section = SECTION::INJECTION;
+			else if (::strncmp(buffer, "[Spool]", 7U) == 0)
+				section = SECTION::SPOOL;
+			else if (::strncmp(buffer, "[Statistics]", 12U) == 0)
+				section = SECTION::STATISTICS;
+			else if (::strncmp(buffer, "[Metrics]", 9U) == 0)
+				section = SECTION::METRICS;
+			else if (::strncmp(buffer, "[StatsPage]", 11U) == 0)
+				section = SECTION::STATSPAGE;
+			else if (::strncmp(buffer, "[Profiler]", 10U) == 0)
+				section = SECTION::PROFILER;
+			else if (::strncmp(buffer, "[Trace]", 7U) == 0)
+				section = SECTION::TRACE;
+			else if (::strncmp(buffer, "[Watchdog]", 10U) == 0)
+				section = SECTION::WATCHDOG;
+			else if (::strncmp(buffer, "[RealTime]", 10U) == 0)
+				section = SECTION::REALTIME;
+			else if (::strncmp(buffer, "[Capture]", 9U) == 0)
+				section = SECTION::CAPTURE;
 			else
 				section = SECTION::NONE;
 
@@ -177,6 +255,16 @@ bool CConf::read()
 				m_mqttUsername = value;
 			else if (::strcmp(key, "Password") == 0)
 				m_mqttPassword = value;
+			else if (::strcmp(key, "BatchTime") == 0)
+				m_mqttBatchTime = (unsigned int)::atoi(value);
+			else if (::strcmp(key, "BatchSize") == 0)
+				m_mqttBatchSize = (unsigned int)::atoi(value);
+			else if (::strcmp(key, "BufferSize") == 0)
+				m_mqttBufferSize = (unsigned int)::atoi(value);
+			else if (::strcmp(key, "ReplayRate") == 0)
+				m_mqttReplayRate = (unsigned int)::atoi(value);
+			else if (::strcmp(key, "MessageEvents") == 0)
+				m_mqttMessageEvents = ::atoi(value) == 1;
 		} else if (section == SECTION::DAPNET) {
 			if (::strcmp(key, "Address") == 0)
 				m_dapnetAddress = value;
@@ -189,6 +277,97 @@ bool CConf::read()
 				}
 			} else if (::strcmp(key, "Debug") == 0)
 				m_dapnetDebug = ::atoi(value) == 1;
+			else if (::strcmp(key, "HealthInterval") == 0)
+				m_dapnetHealthInterval = (unsigned int)::atoi(value);
+			else if (::strcmp(key, "MaxRTT") == 0)
+				m_dapnetMaxRTT = (unsigned int)::atoi(value);
+			else if (::strcmp(key, "MaxRetransmits") == 0)
+				m_dapnetMaxRetransmits = (unsigned int)::atoi(value);
+			else if (::strcmp(key, "AckTimeout") == 0)
+				m_dapnetAckTimeout = (unsigned int)::atoi(value);
+			else if (::strcmp(key, "DegradedSamples") == 0)
+				m_dapnetDegradedSamples = (unsigned int)::atoi(value);
+			else if (::strcmp(key, "TimeSync") == 0)
+				m_dapnetTimeSync = ::atoi(value) == 1;
+		} else if (section == SECTION::EVENTLOG) {
+			if (::strcmp(key, "Enable") == 0)
+				m_eventLogEnabled = ::atoi(value) == 1;
+			else if (::strcmp(key, "File") == 0)
+				m_eventLogFile = value;
+			else if (::strcmp(key, "Size") == 0)
+				m_eventLogSize = (unsigned int)::atoi(value);
+			else if (::strcmp(key, "Files") == 0)
+				m_eventLogFiles = (unsigned int)::atoi(value);
+			else if (::strcmp(key, "Frames") == 0)
+				m_eventLogFrames = ::atoi(value) == 1;
+		} else if (section == SECTION::INJECTION) {
+			if (::strcmp(key, "Enable") == 0)
+				m_injectionEnabled = ::atoi(value) == 1;
+			else if (::strcmp(key, "Rate") == 0)
+				m_injectionRate = (unsigned int)::atoi(value);
+			else if (::strcmp(key, "Burst") == 0)
+				m_injectionBurst = (unsigned int)::atoi(value);
+			else if (::strcmp(key, "Queue") == 0)
+				m_injectionQueue = (unsigned int)::atoi(value);
+		} else if (section == SECTION::SPOOL) {
+			if (::strcmp(key, "Enable") == 0)
+				m_spoolEnabled = ::atoi(value) == 1;
+			else if (::strcmp(key, "Directory") == 0)
+				m_spoolDirectory = value;
+		} else if (section == SECTION::STATISTICS) {
+			if (::strcmp(key, "Interval") == 0)
+				m_statisticsInterval = (unsigned int)::atoi(value);
+			else if (::strcmp(key, "Slots") == 0)
+				m_statisticsSlots = ::atoi(value) == 1;
+			else if (::strcmp(key, "TopInterval") == 0)
+				m_statisticsTopInterval = (unsigned int)::atoi(value);
+			else if (::strcmp(key, "TopCount") == 0)
+				m_statisticsTopCount = (unsigned int)::atoi(value);
+		} else if (section == SECTION::METRICS) {
+			if (::strcmp(key, "Enable") == 0)
+				m_metricsEnabled = ::atoi(value) == 1;
+			else if (::strcmp(key, "Address") == 0)
+				m_metricsAddress = value;
+			else if (::strcmp(key, "Port") == 0)
+				m_metricsPort = (unsigned short)::atoi(value);
+		} else if (section == SECTION::STATSPAGE) {
+			if (::strcmp(key, "Enable") == 0)
+				m_statsPageEnabled = ::atoi(value) == 1;
+			else if (::strcmp(key, "Name") == 0)
+				m_statsPageName = value;
+		} else if (section == SECTION::PROFILER) {
+			if (::strcmp(key, "Enable") == 0)
+				m_profilerEnabled = ::atoi(value) == 1;
+			else if (::strcmp(key, "Interval") == 0)
+				m_profilerInterval = (unsigned int)::atoi(value);
+		} else if (section == SECTION::TRACE) {
+			if (::strcmp(key, "Enable") == 0)
+				m_traceEnabled = ::atoi(value) == 1;
+			else if (::strcmp(key, "Events") == 0)
+				m_traceEvents = (unsigned int)::atoi(value);
+			else if (::strcmp(key, "Directory") == 0)
+				m_traceDirectory = value;
+		} else if (section == SECTION::WATCHDOG) {
+			if (::strcmp(key, "Enable") == 0)
+				m_watchdogEnabled = ::atoi(value) == 1;
+			else if (::strcmp(key, "Threshold") == 0)
+				m_watchdogThreshold = (unsigned int)::atoi(value);
+			else if (::strcmp(key, "Systemd") == 0)
+				m_watchdogSystemd = ::atoi(value) == 1;
+		} else if (section == SECTION::REALTIME) {
+			if (::strcmp(key, "Enable") == 0)
+				m_realTimeEnabled = ::atoi(value) == 1;
+			else if (::strcmp(key, "Priority") == 0)
+				m_realTimePriority = (unsigned int)::atoi(value);
+			else if (::strcmp(key, "CPU") == 0)
+				m_realTimeCPU = ::atoi(value);
+			else if (::strcmp(key, "LockMemory") == 0)
+				m_realTimeLockMemory = ::atoi(value) == 1;
+		} else if (section == SECTION::CAPTURE) {
+			if (::strcmp(key, "Enable") == 0)
+				m_captureEnabled = ::atoi(value) == 1;
+			else if (::strcmp(key, "File") == 0)
+				m_captureFile = value;
 		}
 	}
 
@@ -292,6 +471,31 @@ std::string CConf::getMQTTPassword() const
 	return m_mqttPassword;
 }
 
+unsigned int CConf::getMQTTBatchTime() const
+{
+	return m_mqttBatchTime;
+}
+
+unsigned int CConf::getMQTTBatchSize() const
+{
+	return m_mqttBatchSize;
+}
+
+unsigned int CConf::getMQTTBufferSize() const
+{
+	return m_mqttBufferSize;
+}
+
+unsigned int CConf::getMQTTReplayRate() const
+{
+	return m_mqttReplayRate;
+}
+
+bool CConf::getMQTTMessageEvents() const
+{
+	return m_mqttMessageEvents;
+}
+
 std::string CConf::getDAPNETAddress() const
 {
 	return m_dapnetAddress;
@@ -311,3 +515,203 @@ bool CConf::getDAPNETDebug() const
 {
 	return m_dapnetDebug;
 }
+
+unsigned int CConf::getDAPNETHealthInterval() const
+{
+	return m_dapnetHealthInterval;
+}
+
+unsigned int CConf::getDAPNETMaxRTT() const
+{
+	return m_dapnetMaxRTT;
+}
+
+unsigned int CConf::getDAPNETMaxRetransmits() const
+{
+	return m_dapnetMaxRetransmits;
+}
+
+unsigned int CConf::getDAPNETAckTimeout() const
+{
+	return m_dapnetAckTimeout;
+}
+
+unsigned int CConf::getDAPNETDegradedSamples() const
+{
+	return m_dapnetDegradedSamples;
+}
+
+bool CConf::getDAPNETTimeSync() const
+{
+	return m_dapnetTimeSync;
+}
+
+bool CConf::getEventLogEnabled() const
+{
+	return m_eventLogEnabled;
+}
+
+std::string CConf::getEventLogFile() const
+{
+	return m_eventLogFile;
+}
+
+unsigned int CConf::getEventLogSize() const
+{
+	return m_eventLogSize;
+}
+
+unsigned int CConf::getEventLogFiles() const
+{
+	return m_eventLogFiles;
+}
+
+bool CConf::getEventLogFrames() const
+{
+	return m_eventLogFrames;
+}
+
+bool CConf::getInjectionEnabled() const
+{
+	return m_injectionEnabled;
+}
+
+unsigned int CConf::getInjectionRate() const
+{
+	return m_injectionRate;
+}
+
+unsigned int CConf::getInjectionBurst() const
+{
+	return m_injectionBurst;
+}
+
+unsigned int CConf::getInjectionQueue() const
+{
+	return m_injectionQueue;
+}
+
+bool CConf::getSpoolEnabled() const
+{
+	return m_spoolEnabled;
+}
+
+std::string CConf::getSpoolDirectory() const
+{
+	return m_spoolDirectory;
+}
+
+unsigned int CConf::getStatisticsInterval() const
+{
+	return m_statisticsInterval;
+}
+
+bool CConf::getStatisticsSlots() const
+{
+	return m_statisticsSlots;
+}
+
+unsigned int CConf::getStatisticsTopInterval() const
+{
+	return m_statisticsTopInterval;
+}
+
+unsigned int CConf::getStatisticsTopCount() const
+{
+	return m_statisticsTopCount;
+}
+
+bool CConf::getMetricsEnabled() const
+{
+	return m_metricsEnabled;
+}
+
+std::string CConf::getMetricsAddress() const
+{
+	return m_metricsAddress;
+}
+
+unsigned short CConf::getMetricsPort() const
+{
+	return m_metricsPort;
+}
+
+bool CConf::getStatsPageEnabled() const
+{
+	return m_statsPageEnabled;
+}
+
+std::string CConf::getStatsPageName() const
+{
+	return m_statsPageName;
+}
+
+bool CConf::getProfilerEnabled() const
+{
+	return m_profilerEnabled;
+}
+
+unsigned int CConf::getProfilerInterval() const
+{
+	return m_profilerInterval;
+}
+
+bool CConf::getTraceEnabled() const
+{
+	return m_traceEnabled;
+}
+
+unsigned int CConf::getTraceEvents() const
+{
+	return m_traceEvents;
+}
+
+std::string CConf::getTraceDirectory() const
+{
+	return m_traceDirectory;
+}
+
+bool CConf::getWatchdogEnabled() const
+{
+	return m_watchdogEnabled;
+}
+
+unsigned int CConf::getWatchdogThreshold() const
+{
+	return m_watchdogThreshold;
+}
+
+bool CConf::getWatchdogSystemd() const
+{
+	return m_watchdogSystemd;
+}
+
+bool CConf::getRealTimeEnabled() const
+{
+	return m_realTimeEnabled;
+}
+
+unsigned int CConf::getRealTimePriority() const
+{
+	return m_realTimePriority;
+}
+
+int CConf::getRealTimeCPU() const
+{
+	return m_realTimeCPU;
+}
+
+bool CConf::getRealTimeLockMemory() const
+{
+	return m_realTimeLockMemory;
+}
+
+bool CConf::getCaptureEnabled() const
+{
+	return m_captureEnabled;
+}
+
+std::string CConf::getCaptureFile() const
+{
+	return m_captureFile;
+}
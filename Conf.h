@@ -1,5 +1,5 @@
 /*
- *   Copyright (C) 2018,2023,2025 by Jonathan Naylor G4KLX
+ *   Copyright (C) 2018,2023,2025,2026 by Jonathan Naylor G4KLX
  *
  *   This program is free software; you can redistribute it and/or modify
  *   it under the terms of the GNU General Public License as published by
@@ -54,12 +54,79 @@ public:
 	bool           getMQTTAuthEnabled() const;
 	std::string    getMQTTUsername() const;
 	std::string    getMQTTPassword() const;
+	unsigned int   getMQTTBatchTime() const;
+	unsigned int   getMQTTBatchSize() const;
+	unsigned int   getMQTTBufferSize() const;
+	unsigned int   getMQTTReplayRate() const;
+	bool           getMQTTMessageEvents() const;
 
 	// The DAPNET section
 	std::string  getDAPNETAddress() const;
 	unsigned short getDAPNETPort() const;
 	std::string  getDAPNETAuthKey() const;
 	bool         getDAPNETDebug() const;
+	unsigned int getDAPNETHealthInterval() const;
+	unsigned int getDAPNETMaxRTT() const;
+	unsigned int getDAPNETMaxRetransmits() const;
+	unsigned int getDAPNETAckTimeout() const;
+	unsigned int getDAPNETDegradedSamples() const;
+	bool         getDAPNETTimeSync() const;
+
+	// The Event Log section
+	bool         getEventLogEnabled() const;
+	std::string  getEventLogFile() const;
+	unsigned int getEventLogSize() const;
+	unsigned int getEventLogFiles() const;
+	bool         getEventLogFrames() const;
+
+	// The Injection section
+	bool         getInjectionEnabled() const;
+	unsigned int getInjectionRate() const;
+	unsigned int getInjectionBurst() const;
+	unsigned int getInjectionQueue() const;
+
+	// The Spool section
+	bool         getSpoolEnabled() const;
+	std::string  getSpoolDirectory() const;
+
+	// The Statistics section
+	unsigned int getStatisticsInterval() const;
+	bool         getStatisticsSlots() const;
+	unsigned int getStatisticsTopInterval() const;
+	unsigned int getStatisticsTopCount() const;
+
+	// The Metrics section
+	bool           getMetricsEnabled() const;
+	std::string    getMetricsAddress() const;
+	unsigned short getMetricsPort() const;
+
+	// The StatsPage section
+	bool           getStatsPageEnabled() const;
+	std::string    getStatsPageName() const;
+
+	// The Profiler section
+	bool           getProfilerEnabled() const;
+	unsigned int   getProfilerInterval() const;
+
+	// The Trace section
+	bool           getTraceEnabled() const;
+	unsigned int   getTraceEvents() const;
+	std::string    getTraceDirectory() const;
+
+	// The Watchdog section
+	bool           getWatchdogEnabled() const;
+	unsigned int   getWatchdogThreshold() const;
+	bool           getWatchdogSystemd() const;
+
+	// The RealTime section
+	bool           getRealTimeEnabled() const;
+	unsigned int   getRealTimePriority() const;
+	int            getRealTimeCPU() const;
+	bool           getRealTimeLockMemory() const;
+
+	// The Capture section
+	bool           getCaptureEnabled() const;
+	std::string    getCaptureFile() const;
 
 private:
 	std::string  m_file;
@@ -86,11 +153,67 @@ private:
 	bool           m_mqttAuthEnabled;
 	std::string    m_mqttUsername;
 	std::string    m_mqttPassword;
+	unsigned int   m_mqttBatchTime;
+	unsigned int   m_mqttBatchSize;
+	unsigned int   m_mqttBufferSize;
+	unsigned int   m_mqttReplayRate;
+	bool           m_mqttMessageEvents;
 
 	std::string  m_dapnetAddress;
 	unsigned short m_dapnetPort;
 	std::string  m_dapnetAuthKey;
 	bool         m_dapnetDebug;
+	unsigned int m_dapnetHealthInterval;
+	unsigned int m_dapnetMaxRTT;
+	unsigned int m_dapnetMaxRetransmits;
+	unsigned int m_dapnetAckTimeout;
+	unsigned int m_dapnetDegradedSamples;
+	bool         m_dapnetTimeSync;
+
+	bool         m_eventLogEnabled;
+	std::string  m_eventLogFile;
+	unsigned int m_eventLogSize;
+	unsigned int m_eventLogFiles;
+	bool         m_eventLogFrames;
+
+	bool         m_injectionEnabled;
+	unsigned int m_injectionRate;
+	unsigned int m_injectionBurst;
+	unsigned int m_injectionQueue;
+
+	bool         m_spoolEnabled;
+	std::string  m_spoolDirectory;
+
+	unsigned int m_statisticsInterval;
+	bool         m_statisticsSlots;
+	unsigned int m_statisticsTopInterval;
+	unsigned int m_statisticsTopCount;
+
+	bool           m_metricsEnabled;
+	std::string    m_metricsAddress;
+	unsigned short m_metricsPort;
+
+	bool           m_statsPageEnabled;
+	std::string    m_statsPageName;
+
+	bool           m_profilerEnabled;
+	unsigned int   m_profilerInterval;
+
+	bool           m_traceEnabled;
+	unsigned int   m_traceEvents;
+	std::string    m_traceDirectory;
+
+	bool           m_watchdogEnabled;
+	unsigned int   m_watchdogThreshold;
+	bool           m_watchdogSystemd;
+
+	bool           m_realTimeEnabled;
+	unsigned int   m_realTimePriority;
+	int            m_realTimeCPU;
+	bool           m_realTimeLockMemory;
+
+	bool           m_captureEnabled;
+	std::string    m_captureFile;
 };
 
 #endif
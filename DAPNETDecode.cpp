@@ -0,0 +1,201 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+// Renders a binary event log written by the DAPNET Gateway as text or JSON
+
+#include "EventLog.h"
+
+#include <nlohmann/json.hpp>
+
+#include <string>
+#include <vector>
+
+#include <cstdio>
+#include <cctype>
+#include <cstring>
+#include <ctime>
+
+static std::string timestamp(unsigned long long time)
+{
+	time_t secs = time_t(time / 1000000ULL);
+
+	struct tm tm;
+	::gmtime_r(&secs, &tm);
+
+	char buffer[50U];
+	::snprintf(buffer, 50U, "%04d-%02d-%02dT%02d:%02d:%02d.%06uZ", tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec, (unsigned int)(time % 1000000ULL));
+
+	return buffer;
+}
+
+static std::string printable(const std::vector<unsigned char>& data)
+{
+	std::string text;
+
+	for (std::vector<unsigned char>::const_iterator it = data.cbegin(); it != data.cend(); ++it) {
+		if (::isprint(*it)) {
+			text += char(*it);
+		} else {
+			char temp[10U];
+			::snprintf(temp, 10U, "\\x%02X", *it);
+			text += temp;
+		}
+	}
+
+	return text;
+}
+
+static std::string hex(const std::vector<unsigned char>& data)
+{
+	std::string text;
+
+	for (std::vector<unsigned char>::const_iterator it = data.cbegin(); it != data.cend(); ++it) {
+		char temp[10U];
+		::snprintf(temp, 10U, "%02X", *it);
+		text += temp;
+	}
+
+	return text;
+}
+
+static bool decode(const char* fileName, bool json)
+{
+	FILE* fp = ::fopen(fileName, "rb");
+	if (fp == nullptr) {
+		::fprintf(stderr, "dapnetdecode: cannot open %s\n", fileName);
+		return false;
+	}
+
+	CEventHeader header;
+	if (::fread(&header, sizeof(CEventHeader), 1U, fp) != 1U || ::memcmp(header.m_magic, EVENT_MAGIC, 8U) != 0) {
+		::fprintf(stderr, "dapnetdecode: %s is not an event log\n", fileName);
+		::fclose(fp);
+		return false;
+	}
+
+	if (header.m_version != EVENT_VERSION || header.m_recordLength != EVENT_RECORD_LENGTH) {
+		::fprintf(stderr, "dapnetdecode: %s has an unsupported version %u\n", fileName, header.m_version);
+		::fclose(fp);
+		return false;
+	}
+
+	unsigned int count = header.m_count;
+	if (count > header.m_capacity)
+		count = header.m_capacity;
+
+	std::vector<CEventRecord> records(count);
+	count = (unsigned int)::fread(records.data(), sizeof(CEventRecord), count, fp);
+
+	::fclose(fp);
+
+	for (unsigned int i = 0U; i < count; i++) {
+		const CEventRecord& record = records[i];
+
+		if (record.m_type == (unsigned char)EVENT_TYPE::CONTINUATION || record.m_type > (unsigned char)EVENT_TYPE::POCSAG_TX)
+			continue;
+
+		// Gather the data from any continuation records
+		unsigned int length = record.m_length;
+		unsigned int first  = length > EVENT_DATA_LENGTH ? EVENT_DATA_LENGTH : length;
+
+		std::vector<unsigned char> data(record.m_data, record.m_data + first);
+		for (unsigned int j = 0U; j < record.m_count && (i + 1U) < count; j++) {
+			const unsigned char* p = (const unsigned char*)&records[++i];
+
+			unsigned int n = length - (unsigned int)data.size();
+			if (n > EVENT_EXTRA_LENGTH)
+				n = EVENT_EXTRA_LENGTH;
+
+			data.insert(data.end(), p + 1U, p + 1U + n);
+		}
+
+		bool message = record.m_type >= (unsigned char)EVENT_TYPE::MESSAGE_RECEIVED && record.m_type <= (unsigned char)EVENT_TYPE::MESSAGE_REJECTED;
+		const char* type   = ::EventTypeName(EVENT_TYPE(record.m_type));
+		const char* reason = ::EventReasonName(EVENT_REASON(record.m_reason));
+
+		if (json) {
+			nlohmann::json event;
+
+			event["timestamp"] = timestamp(record.m_time);
+			event["event"]     = type;
+
+			if (message) {
+				event["id"]         = record.m_id;
+				event["ric"]        = record.m_ric;
+				event["type"]       = record.m_msgType;
+				event["functional"] = record.m_functional;
+				event["message"]    = printable(data);
+
+				if (record.m_type == (unsigned char)EVENT_TYPE::MESSAGE_FILTERED || record.m_type == (unsigned char)EVENT_TYPE::MESSAGE_REJECTED)
+					event["reason"] = reason;
+				if (record.m_type == (unsigned char)EVENT_TYPE::MESSAGE_SENT || record.m_type == (unsigned char)EVENT_TYPE::MESSAGE_REJECTED)
+					event["slot"] = record.m_slot;
+			} else {
+				event["data"] = hex(data);
+			}
+
+			::fprintf(stdout, "%s\n", event.dump().c_str());
+		} else {
+			if (message) {
+				::fprintf(stdout, "%s %-9s id=%u ric=%07u type=%u func=%u", timestamp(record.m_time).c_str(), type, record.m_id, record.m_ric, record.m_msgType, record.m_functional);
+
+				if (record.m_type == (unsigned char)EVENT_TYPE::MESSAGE_FILTERED || record.m_type == (unsigned char)EVENT_TYPE::MESSAGE_REJECTED)
+					::fprintf(stdout, " reason=%s", reason);
+				if (record.m_type == (unsigned char)EVENT_TYPE::MESSAGE_SENT || record.m_type == (unsigned char)EVENT_TYPE::MESSAGE_REJECTED)
+					::fprintf(stdout, " slot=%u", record.m_slot);
+
+				::fprintf(stdout, " \"%s\"\n", printable(data).c_str());
+			} else {
+				::fprintf(stdout, "%s %-9s len=%u %s\n", timestamp(record.m_time).c_str(), type, length, hex(data).c_str());
+			}
+		}
+	}
+
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	bool json = false;
+
+	std::vector<const char*> files;
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "-j" || arg == "--json") {
+			json = true;
+		} else if (arg.substr(0, 1) == "-") {
+			::fprintf(stderr, "Usage: dapnetdecode [-j|--json] filename...\n");
+			return 1;
+		} else {
+			files.push_back(argv[i]);
+		}
+	}
+
+	if (files.empty()) {
+		::fprintf(stderr, "Usage: dapnetdecode [-j|--json] filename...\n");
+		return 1;
+	}
+
+	int ret = 0;
+	for (std::vector<const char*>::const_iterator it = files.cbegin(); it != files.cend(); ++it) {
+		if (!decode(*it, json))
+			ret = 1;
+	}
+
+	return ret;
+}
@@ -1,5 +1,5 @@
 /*
-*   Copyright (C) 2018,2020,2023,2024,2025 by Jonathan Naylor G4KLX
+*   Copyright (C) 2018,2020,2023,2024,2025,2026 by Jonathan Naylor G4KLX
 *
 *   This program is free software; you can redistribute it and/or modify
 *   it under the terms of the GNU General Public License as published by
@@ -19,6 +19,12 @@
 #include "MQTTConnection.h"
 #include "DAPNETGateway.h"
 #include "StopWatch.h"
+#include "Clock.h"
+#include "SpoolDirectory.h"
+#include "PageInjector.h"
+#include "EventLog.h"
+#include "Capture.h"
+#include "Probes.h"
 #include "Version.h"
 #include "Thread.h"
 #include "Timer.h"
@@ -49,19 +55,46 @@ const char* DEFAULT_INI_FILE = "/etc/DAPNETGateway.ini";
 // In Log.cpp
 extern CMQTTConnection* m_mqtt;
 
-static bool m_killed = false;
-static int  m_signal = 0;
+static bool m_killed  = false;
+#if !defined(DAPNETSIM)
+static int  m_signal  = 0;
+#endif
+static bool m_profile = false;
+static bool m_dump    = false;
 
-#if !defined(_WIN32) && !defined(_WIN64)
+// Page requests arrive on the MQTT thread, which may outlive the gateway
+static CPageInjector* m_injector = nullptr;
+static std::mutex     m_injectorMutex;
+
+static void onPage(const unsigned char* data, unsigned int length)
+{
+	std::lock_guard<std::mutex> lock(m_injectorMutex);
+
+	if (m_injector != nullptr)
+		m_injector->write(data, length);
+}
+
+#if !defined(_WIN32) && !defined(_WIN64) && !defined(DAPNETSIM)
 static void sigHandler(int signum)
 {
 	m_killed = true;
 	m_signal = signum;
 }
+
+static void sigUsr1Handler(int)
+{
+	m_profile = true;
+}
+
+static void sigUsr2Handler(int)
+{
+	m_dump = true;
+}
 #endif
 
 #include <algorithm>
 #include <utility>
+#include <mutex>
 
 #include <cstdio>
 #include <cstdlib>
@@ -69,6 +102,7 @@ static void sigHandler(int signum)
 #include <clocale>
 #include <cassert>
 #include <cmath>
+#include <ctime>
 
 const unsigned int FRAME_LENGTH_CODEWORDS    = 2U;
 const unsigned int BATCH_LENGTH_CODEWORDS    = 17U;
@@ -92,7 +126,12 @@ const unsigned char FUNCTIONAL_ALPHANUMERIC = 3U;
 
 const unsigned int MAX_TIME_TO_HOLD_TIME_MESSAGES = 15000U;		// 15s
 
+const unsigned int SPOOL_PAGES_PER_PASS = 500U;
+
+const unsigned int TIMING_EVENTS = 200U;		// Room for what is done while the main loop is busy
+
 
+#if !defined(DAPNETSIM)
 int main(int argc, char** argv)
 {
 	const char* iniFile = DEFAULT_INI_FILE;
@@ -115,6 +154,8 @@ int main(int argc, char** argv)
 	::signal(SIGINT,  sigHandler);
 	::signal(SIGTERM, sigHandler);
 	::signal(SIGHUP,  sigHandler);
+	::signal(SIGUSR1, sigUsr1Handler);
+	::signal(SIGUSR2, sigUsr2Handler);
 #endif
 
 	int ret = 0;
@@ -132,16 +173,16 @@ int main(int argc, char** argv)
 			case 0:
 				break;
 			case 2:
-				::LogInfo("DAPNETGateway-%s exited on receipt of SIGINT", VERSION);
+				LogInfo("DAPNETGateway-%s exited on receipt of SIGINT", VERSION);
 				break;
 			case 15:
-				::LogInfo("DAPNETGateway-%s exited on receipt of SIGTERM", VERSION);
+				LogInfo("DAPNETGateway-%s exited on receipt of SIGTERM", VERSION);
 				break;
 			case 1:
-				::LogInfo("DAPNETGateway-%s is restarting on receipt of SIGHUP", VERSION);
+				LogInfo("DAPNETGateway-%s is restarting on receipt of SIGHUP", VERSION);
 				break;
 			default:
-				::LogInfo("DAPNETGateway-%s exited on receipt of an unknown signal", VERSION);
+				LogInfo("DAPNETGateway-%s exited on receipt of an unknown signal", VERSION);
 				break;
 		}
 	} while (m_signal == 1);
@@ -150,21 +191,71 @@ int main(int argc, char** argv)
 
 	return ret;
 }
+#endif
 
 CDAPNETGateway::CDAPNETGateway(const std::string& configFile) :
 m_conf(configFile),
 m_dapnetNetwork(nullptr),
 m_pocsagNetwork(nullptr),
 m_queue(),
-m_slotTimer(),
+m_slotClock(),
+m_slotStarted(false),
 m_schedule(nullptr),
 m_allSlots(false),
+m_newSchedule(nullptr),
 m_currentSlot(0U),
 m_sentCodewords(0U),
 m_regexBlacklist(),
 m_regexWhitelist(),
-m_mmdvmFree(false)
+m_whiteList(),
+m_blackList(),
+m_blacklistRegexes(),
+m_whitelistRegexes(),
+m_spool(nullptr),
+m_messageEvents(false),
+m_queueWait(),
+m_latency(),
+m_slotWait(),
+m_statsTimer(1000U),
+m_slotStatsEnabled(false),
+m_slotStats(),
+m_cycleStats(),
+m_cycleReady(false),
+m_deferredId(0U),
+m_fullCycle(false),
+m_topRICs(),
+m_topTypes(),
+m_topTimer(1000U),
+m_topCount(0U),
+m_metrics(),
+m_metricsServer(nullptr),
+m_statsPage(nullptr),
+m_profiler(),
+m_profileTimer(1000U),
+m_trace(),
+m_traceSlotStart(0U),
+m_traceBusyStart(0U),
+m_watchdog(nullptr),
+m_healthTimer(1000U),
+m_degradedSamples(0U),
+m_reconnecting(false),
+m_reconnectTimer(1000U),
+m_reconnectFails(0U),
+m_traceReconnectStart(0U),
+m_timeSync(false),
+m_mutex(),
+m_events(),
+m_completed(),
+m_slotOffset(0),
+m_slotOffsetValid(false),
+m_timingThread(nullptr),
+m_embedded(false),
+m_mmdvmFree(false),
+m_mmdvmFreed(false)
 {
+	m_events.reserve(TIMING_EVENTS);
+	m_completed.reserve(TIMING_EVENTS);
+
 	CUDPSocket::startup();
 }
 
@@ -175,6 +266,16 @@ CDAPNETGateway::~CDAPNETGateway()
 
 	m_queue.clear();
 
+	for (const CTimingEvent& event : m_events)
+		delete event.m_message;
+
+	delete[] m_schedule;
+	delete[] m_newSchedule;
+
+	std::lock_guard<std::mutex> lock(m_injectorMutex);
+	delete m_injector;
+	m_injector = nullptr;
+
 	CUDPSocket::shutdown();
 }
 
@@ -189,7 +290,7 @@ int CDAPNETGateway::run()
 	setlocale(LC_ALL, "C");
 
 #if !defined(_WIN32) && !defined(_WIN64)
-	bool m_daemon = m_conf.getDaemon();
+	bool m_daemon = m_conf.getDaemon() && !m_embedded;
 	if (m_daemon) {
 		// Create new process
 		pid_t pid = ::fork();
@@ -251,27 +352,53 @@ int CDAPNETGateway::run()
 	}
 #endif
 
-	::LogInitialise(m_conf.getLogDisplayLevel(), m_conf.getLogMQTTLevel());
+	if (!m_embedded)
+		::LogInitialise(m_conf.getLogDisplayLevel(), m_conf.getLogMQTTLevel());
 
 	std::vector<std::pair<std::string, void (*)(const unsigned char*, unsigned int)>> subscriptions;
-	m_mqtt = new CMQTTConnection(m_conf.getMQTTAddress(), m_conf.getMQTTPort(), m_conf.getMQTTName(), m_conf.getMQTTAuthEnabled(), m_conf.getMQTTUsername(), m_conf.getMQTTPassword(), subscriptions, m_conf.getMQTTKeepalive());
-	ret = m_mqtt->open();
-	if (!ret) {
-		delete m_mqtt;
-		return -1;
+	if (m_conf.getInjectionEnabled() && !m_embedded) {
+		std::lock_guard<std::mutex> lock(m_injectorMutex);
+		m_injector = new CPageInjector(m_conf.getInjectionRate(), m_conf.getInjectionBurst(), m_conf.getInjectionQueue());
+
+		subscriptions.push_back(std::make_pair("page", onPage));
+	}
+
+	if (!m_embedded) {
+		m_mqtt = new CMQTTConnection(m_conf.getMQTTAddress(), m_conf.getMQTTPort(), m_conf.getMQTTName(), m_conf.getMQTTAuthEnabled(), m_conf.getMQTTUsername(), m_conf.getMQTTPassword(), subscriptions, m_conf.getMQTTKeepalive());
+		if (m_conf.getMQTTBatchTime() > 0U)
+			m_mqtt->setBatching(m_conf.getMQTTBatchTime(), m_conf.getMQTTBatchSize());
+		if (m_conf.getMQTTReplayRate() > 0U)
+			m_mqtt->setBuffering(m_conf.getMQTTBufferSize(), m_conf.getMQTTReplayRate());
+		ret = m_mqtt->open();
+		if (!ret) {
+			delete m_mqtt;
+			m_mqtt = nullptr;
+			return -1;
+		}
 	}
 
+	m_messageEvents = m_conf.getMQTTMessageEvents();
+
+	if (m_conf.getEventLogEnabled())
+		::EventInitialise(m_conf.getEventLogFile(), m_conf.getEventLogSize(), m_conf.getEventLogFiles(), m_conf.getEventLogFrames());
+
+	// For replay by dapnetsim, not when embedded as the traffic is already simulated or replayed
+	if (m_conf.getCaptureEnabled() && !m_embedded)
+		::CaptureInitialise(m_conf.getCaptureFile());
+
 	bool debug             = m_conf.getDAPNETDebug();
+	m_timeSync             = m_conf.getDAPNETTimeSync();
 
 	std::string rptAddress = m_conf.getRptAddress();
 	unsigned short rptPort = m_conf.getRptPort();
 	std::string myAddress  = m_conf.getMyAddress();
 	unsigned short myPort  = m_conf.getMyPort();
 
-	m_pocsagNetwork = new CPOCSAGNetwork(myAddress, myPort, rptAddress, rptPort, debug);
+	if (m_pocsagNetwork == nullptr)
+		m_pocsagNetwork = new CPOCSAGNetwork(myAddress, myPort, rptAddress, rptPort, debug);
 	ret = m_pocsagNetwork->open();
 	if (!ret) {
-		::LogError("Cannot open the repeater network port");
+		LogError("Cannot open the repeater network port");
 		return 1;
 	}
 
@@ -280,12 +407,13 @@ int CDAPNETGateway::run()
 	unsigned short dapnetPort = m_conf.getDAPNETPort();
 	std::string dapnetAuthKey = m_conf.getDAPNETAuthKey();
 
-	if (dapnetAuthKey.length() == 0 || dapnetAuthKey == "TOPSECRET") {
-		::LogError("AuthKey not set or invalid");
+	if (!m_embedded && (dapnetAuthKey.length() == 0 || dapnetAuthKey == "TOPSECRET")) {
+		LogError("AuthKey not set or invalid");
 		return 1;
 	}
 		
-	m_dapnetNetwork = new CDAPNETNetwork(dapnetAddress, dapnetPort, callsign, dapnetAuthKey, VERSION, false, 1, debug);
+	if (m_dapnetNetwork == nullptr)
+		m_dapnetNetwork = new CDAPNETNetwork(dapnetAddress, dapnetPort, callsign, dapnetAuthKey, VERSION, false, 1, debug, m_timeSync);
 	ret = m_dapnetNetwork->open();
 	if (!ret) {
 		m_pocsagNetwork->close();
@@ -293,7 +421,7 @@ int CDAPNETGateway::run()
 		delete m_pocsagNetwork;
 		delete m_dapnetNetwork;
 
-		::LogError("Cannot open the DAPNET network port");
+		LogError("Cannot open the DAPNET network port");
 
 		return 1;
 	}
@@ -306,33 +434,103 @@ int CDAPNETGateway::run()
 		delete m_pocsagNetwork;
 		delete m_dapnetNetwork;
 
-		::LogError("Cannot login to the DAPNET network");
+		LogError("Cannot login to the DAPNET network");
 
 		return 1;
 	}
 
-	std::vector<unsigned int> whiteList = m_conf.getWhiteList();
-	std::vector<unsigned int> blackList = m_conf.getBlackList();
-
-	std::vector<std::regex> regexBlacklist;
-	std::vector<std::regex> regexWhitelist;
+	m_whiteList = m_conf.getWhiteList();
+	m_blackList = m_conf.getBlackList();
 
 	LogMessage("Initializing blacklist");
 	m_regexBlacklist = new CREGEX(m_conf.getblacklistRegexfile());
 	if (m_regexBlacklist->load()) 
-		regexBlacklist = m_regexBlacklist->get();
+		m_blacklistRegexes = m_regexBlacklist->get();
 
 	LogMessage("Initializing whitelist");
 	m_regexWhitelist = new CREGEX(m_conf.getwhitelistRegexfile());
 		if (m_regexWhitelist->load())
-		regexWhitelist = m_regexWhitelist->get();
+		m_whitelistRegexes = m_regexWhitelist->get();
+
+	if (m_conf.getSpoolEnabled()) {
+		m_spool = new CSpoolDirectory(m_conf.getSpoolDirectory());
+		if (!m_spool->open()) {
+			delete m_spool;
+			m_spool = nullptr;
+		}
+	}
 
 	LogInfo("DAPNETGateway-%s is starting", VERSION);
 	LogInfo("Built %s %s (GitID #%.7s)", __TIME__, __DATE__, gitversion);
 
 	writeJSONStatus("DAPNETGateway is starting");
 
+	if (m_conf.getStatisticsInterval() > 0U)
+		m_statsTimer.start(m_conf.getStatisticsInterval());
+
+	m_slotStatsEnabled = m_conf.getStatisticsSlots();
+
+	m_topCount = m_conf.getStatisticsTopCount();
+	if (m_conf.getStatisticsTopInterval() > 0U && m_topCount > 0U)
+		m_topTimer.start(m_conf.getStatisticsTopInterval());
+
+	if (m_conf.getMetricsEnabled()) {
+		m_metricsServer = new CMetricsServer(m_conf.getMetricsAddress(), m_conf.getMetricsPort(), m_metrics);
+		if (!m_metricsServer->open()) {
+			delete m_metricsServer;
+			m_metricsServer = nullptr;
+		}
+	}
+
+	if (m_conf.getStatsPageEnabled()) {
+		m_statsPage = new CStatsPage(m_conf.getStatsPageName());
+		if (!m_statsPage->open()) {
+			delete m_statsPage;
+			m_statsPage = nullptr;
+		}
+	}
+
+	if (m_conf.getProfilerInterval() > 0U)
+		m_profileTimer.setTimeout(m_conf.getProfilerInterval());
+
+	if (m_conf.getProfilerEnabled())
+		toggleProfiler();
+
+	if (m_conf.getTraceEnabled() && m_conf.getTraceEvents() > 0U)
+		m_trace.open(m_conf.getTraceEvents());
+
+	if (m_conf.getDAPNETHealthInterval() > 0U)
+		m_healthTimer.start(m_conf.getDAPNETHealthInterval());
+
+	if (m_conf.getWatchdogEnabled() && m_conf.getWatchdogThreshold() > 0U && !m_embedded) {
+		m_watchdog = new CWatchdog(m_conf.getWatchdogThreshold(), m_conf.getWatchdogSystemd());
+		if (!m_watchdog->start()) {
+			delete m_watchdog;
+			m_watchdog = nullptr;
+		}
+	}
+
+	if (m_conf.getRealTimeEnabled() && !m_embedded) {
+		m_timingThread = new CTimingThread(*this, m_slotClock, m_conf.getRealTimePriority(), m_conf.getRealTimeCPU(), m_conf.getRealTimeLockMemory());
+		if (!m_timingThread->start()) {
+			delete m_timingThread;
+			m_timingThread = nullptr;
+		}
+	}
+
+	CStopWatch stopWatch;
+	stopWatch.start();
+
+	CStopWatch loopTimer;
+
 	while (!m_killed) {
+		loopTimer.start();
+		m_profiler.start();
+
+		if (m_watchdog != nullptr)
+			m_watchdog->beat();
+		enterStage(STAGE::MMDVM_READ);
+
 		unsigned char buffer[200U];
 
 		if (m_pocsagNetwork->read(buffer) > 0U) {
@@ -341,118 +539,387 @@ int CDAPNETGateway::run()
 				// The MMDVM is idle
 				if (!m_mmdvmFree) {
 					// LogDebug("*** MMDVM is free");
-					m_mmdvmFree = true;
-					m_sentCodewords = (m_slotTimer.elapsed() * 1000U) / CODEWORD_TIME_US;
+					m_mmdvmFree  = true;
+					m_mmdvmFreed = true;
+					PROBE1(mmdvm_free, m_currentSlot.load());
+					if (m_traceBusyStart != 0U)
+						m_trace.span(TRACE_TRACK::MMDVM, "busy", m_traceBusyStart);
 				}
 				break;
 			case 0xFFU:
 				// The MMDVM is busy
 				// LogDebug("*** MMDVM is busy");
+				if (m_mmdvmFree) {
+					PROBE1(mmdvm_busy, m_currentSlot.load());
+					m_traceBusyStart = m_trace.now();
+				}
 				m_mmdvmFree = false;
 				break;
 			default:
 				// The MMDVM is sending crap
-				LogWarning("Unknown data from the MMDVM - 0x%02X", buffer[0U]);
+				LogWarningLimited("Unknown data from the MMDVM - 0x%02X", buffer[0U]);
 				break;
 			}
 		}
 
-		bool ok = m_dapnetNetwork->read();
-		if (!ok)
+		m_profiler.mark(STAGE::MMDVM_READ);
+		enterStage(STAGE::DAPNET_READ);
+
+		uint64_t start = m_trace.now();
+
+		// While the link is down the attempts to reconnect are spaced out, and the rest of the loop carries on
+		if (m_reconnecting || !m_dapnetNetwork->read())
 			recover();
 
+		readSchedule();
+
+		// Align the slots with the DAPNET core's clock
+		if (m_timeSync && m_dapnetNetwork->getTimeSync().isValid()) {
+			m_slotOffset      = m_dapnetNetwork->getTimeSync().getOffset();
+			m_slotOffsetValid = true;
+		}
+
 		CPOCSAGMessage* message = m_dapnetNetwork->readMessage();
-		if (message != nullptr) {
-			bool found = true;
-			bool blackListRIC = false;
-			bool blacklistRegexmatch = false;
-			bool whitelistRegexmatch = true;
-
-			// If we have a white list of RICs, use it.
-			if (!whiteList.empty())
-				found = std::find(whiteList.begin(), whiteList.end(), message->m_ric) != whiteList.end();
-
-			// If we have a black list of RICs, use it.
-			if (!blackList.empty())
-				blackListRIC = std::find(blackList.begin(), blackList.end(), message->m_ric) != blackList.end();
-			if (blackListRIC)
-				LogDebug("Blacklist match: Not queueing message to %07u, type %u, message: \"%.*s\"", message->m_ric, message->m_type, message->m_length, message->m_message);
-
-			std::string  messageBody(reinterpret_cast<char*>(message->m_message));
-			//If we have a list of blacklist REGEXes, use them 
-			if (!regexBlacklist.empty()) {
-				for (std::regex regex : regexBlacklist) {
-					bool ret =  std::regex_match(messageBody,regex);
-					//If the regex matches the message body, don't send the message
-					if (ret) {
-						blacklistRegexmatch = true;
-						LogDebug("Blacklist REGEX match: Not queueing message to %07u, type %u, message: \"%.*s\"", message->m_ric, message->m_type, message->m_length, messageBody.c_str());
-					}
-				}
-			}
+		if (message != nullptr)
+			m_trace.span(TRACE_TRACK::MESSAGES, "parse", start, "id", message->m_id);
 
-			if(!regexWhitelist.empty() && !blacklistRegexmatch) {
-				for (std::regex regex : regexWhitelist) {
-					bool ret =  std::regex_match(messageBody,regex);
-					//If the regex does not match the message body, don't send the message
-					if (!ret) {
-						whitelistRegexmatch = false;
-						LogDebug("No whitelist REGEX match: Not queueing message to %07u, type %u, message: \"%.*s\"", message->m_ric, message->m_type, message->m_length, messageBody.c_str());
-					}
-				}
-			}
+		m_profiler.mark(STAGE::DAPNET_READ);
+		enterStage(STAGE::ADMIT);
 
-			if (found && !blackListRIC && !blacklistRegexmatch && whitelistRegexmatch) {
-				switch (message->m_functional) {
-					case FUNCTIONAL_ALPHANUMERIC:
-						LogDebug("Queueing message to %07u, type %u, func Alphanumeric: \"%.*s\"", message->m_ric, message->m_type, message->m_length, message->m_message);
-						break;
-					case FUNCTIONAL_ALERT2:
-						LogDebug("Queueing message to %07u, type %u, func Alert 2: \"%.*s\"", message->m_ric, message->m_type, message->m_length, message->m_message);
-						break;
-					case FUNCTIONAL_NUMERIC:
-						LogDebug("Queueing message to %07u, type %u, func Numeric: \"%.*s\"", message->m_ric, message->m_type, message->m_length, message->m_message);
-						break;
-					case FUNCTIONAL_ALERT1:
-						LogDebug("Queueing message to %07u, type %u, func Alert 1", message->m_ric, message->m_type);
-						break;
-					default:
-						break;
-				}
+		if (message != nullptr)
+			admitMessage(message);
 
-				m_queue.push_front(message);
-				LogDebug("Messages in Queue %04u", m_queue.size());
+		if (m_injector != nullptr) {
+			while ((message = m_injector->read()) != nullptr)
+				admitMessage(message);
+		}
+
+		// Large spool files are read over several passes to keep the slot timing
+		if (m_spool != nullptr) {
+			for (unsigned int i = 0U; i < SPOOL_PAGES_PER_PASS; i++) {
+				message = m_spool->read();
+				if (message == nullptr)
+					break;
+
+				admitMessage(message);
 			}
 		}
 
-		unsigned int t = (m_slotTimer.time() / 100ULL) % 1024ULL;
-		unsigned int slot = t / 64U;
-		if (slot != m_currentSlot) {
-			// LogDebug("Start of slot %u", slot);
-			m_currentSlot = slot;
-			if (m_schedule == nullptr || m_currentSlot == 0U)
-				loadSchedule();
-			m_sentCodewords = 0U;
-			m_slotTimer.start();
+		m_profiler.mark(STAGE::ADMIT);
+		enterStage(STAGE::SLOT);
+
+		if (m_timingThread == nullptr)
+			checkSlot();
+
+		m_profiler.mark(STAGE::SLOT);
+		enterStage(STAGE::SEND);
+
+		if (m_timingThread == nullptr)
+			sendMessages();
+
+		processEvents();
+
+		m_profiler.mark(STAGE::SEND);
+		enterStage(STAGE::HOUSEKEEPING);
+
+		unsigned int ms = stopWatch.elapsed();
+		stopWatch.start();
+
+		if (m_mqtt != nullptr)
+			m_mqtt->clock(ms);
+
+		m_statsTimer.clock(ms);
+		if (m_statsTimer.isRunning() && m_statsTimer.hasExpired()) {
+			writeJSONLatency();
+			m_statsTimer.start();
+		}
+
+		m_topTimer.clock(ms);
+		if (m_topTimer.isRunning() && m_topTimer.hasExpired()) {
+			writeJSONTop();
+			m_topTimer.start();
+		}
+
+		m_reconnectTimer.clock(ms);
+
+		m_healthTimer.clock(ms);
+		if (m_healthTimer.isRunning() && m_healthTimer.hasExpired()) {
+			checkLinkHealth();
+			m_healthTimer.start();
+		}
+
+		m_profileTimer.clock(ms);
+		if (m_profileTimer.isRunning() && m_profileTimer.hasExpired()) {
+			writeJSONProfile();
+			m_profileTimer.start();
 		}
 
-		sendMessages();
+		if (m_profile) {
+			m_profile = false;
+			toggleProfiler();
+		}
+
+		if (m_dump) {
+			m_dump = false;
+			writeTrace();
+		}
+
+		if (m_metricsServer != nullptr)
+			m_metricsServer->clock(ms);
+
+		updateMetrics();
+		m_metrics.setLoopTime(loopTimer.elapsed());
+
+		if (m_statsPage != nullptr)
+			m_statsPage->update(m_metrics);
+
+		m_profiler.mark(STAGE::HOUSEKEEPING);
+		enterStage(STAGE::SLEEP);
 
-		CThread::sleep(10U);
+		if (m_timingThread == nullptr)
+			m_slotClock.sleep(10U);
+		else
+			CClock::get().sleep(10U);
 	}
 
 	LogInfo("DAPNETGateway is stopping");
 	writeJSONStatus("DAPNETGateway is stopping");
 
+	if (m_timingThread != nullptr) {
+		m_timingThread->stop();
+		delete m_timingThread;
+		m_timingThread = nullptr;
+
+		processEvents();
+	}
+
+	if (m_watchdog != nullptr) {
+		m_watchdog->stop();
+		delete m_watchdog;
+		m_watchdog = nullptr;
+	}
+
+	writeTrace();
+	m_trace.close();
+
 	m_pocsagNetwork->close();
 	delete m_pocsagNetwork;
 
 	m_dapnetNetwork->close();
 	delete m_dapnetNetwork;
 
+	if (m_spool != nullptr) {
+		m_spool->close();
+		delete m_spool;
+	}
+
+	if (m_metricsServer != nullptr) {
+		m_metricsServer->close();
+		delete m_metricsServer;
+	}
+
+	if (m_statsPage != nullptr) {
+		m_statsPage->close();
+		delete m_statsPage;
+	}
+
+	::CaptureFinalise();
+	::EventFinalise();
+
 	return 0;
 }
 
+void CDAPNETGateway::admitMessage(CPOCSAGMessage* message)
+{
+	assert(message != nullptr);
+
+	m_profiler.setMessage(message->m_id);
+
+	uint64_t start = m_trace.now();
+
+	writeMessageEvent(EVENT_TYPE::MESSAGE_RECEIVED, message);
+
+	bool found = true;
+	bool blackListRIC = false;
+	bool blacklistRegexmatch = false;
+	bool whitelistRegexmatch = true;
+
+	// If we have a white list of RICs, use it.
+	if (!m_whiteList.empty())
+		found = std::find(m_whiteList.begin(), m_whiteList.end(), message->m_ric) != m_whiteList.end();
+
+	// If we have a black list of RICs, use it.
+	if (!m_blackList.empty())
+		blackListRIC = std::find(m_blackList.begin(), m_blackList.end(), message->m_ric) != m_blackList.end();
+	if (blackListRIC)
+		LogDebug("Blacklist match: Not queueing message to %07u, type %u, message: \"%.*s\"", message->m_ric, message->m_type, message->m_length, message->m_message);
+
+	std::string  messageBody(reinterpret_cast<char*>(message->m_message));
+	//If we have a list of blacklist REGEXes, use them 
+	if (!m_blacklistRegexes.empty()) {
+		for (const std::regex& regex : m_blacklistRegexes) {
+			bool ret =  std::regex_match(messageBody,regex);
+			//If the regex matches the message body, don't send the message
+			if (ret) {
+				blacklistRegexmatch = true;
+				LogDebug("Blacklist REGEX match: Not queueing message to %07u, type %u, message: \"%.*s\"", message->m_ric, message->m_type, message->m_length, messageBody.c_str());
+			}
+		}
+	}
+
+	if(!m_whitelistRegexes.empty() && !blacklistRegexmatch) {
+		for (const std::regex& regex : m_whitelistRegexes) {
+			bool ret =  std::regex_match(messageBody,regex);
+			//If the regex does not match the message body, don't send the message
+			if (!ret) {
+				whitelistRegexmatch = false;
+				LogDebug("No whitelist REGEX match: Not queueing message to %07u, type %u, message: \"%.*s\"", message->m_ric, message->m_type, message->m_length, messageBody.c_str());
+			}
+		}
+	}
+
+	if (found && !blackListRIC && !blacklistRegexmatch && whitelistRegexmatch) {
+		switch (message->m_functional) {
+			case FUNCTIONAL_ALPHANUMERIC:
+				LogDebug("Queueing message to %07u, type %u, func Alphanumeric: \"%.*s\"", message->m_ric, message->m_type, message->m_length, message->m_message);
+				break;
+			case FUNCTIONAL_ALERT2:
+				LogDebug("Queueing message to %07u, type %u, func Alert 2: \"%.*s\"", message->m_ric, message->m_type, message->m_length, message->m_message);
+				break;
+			case FUNCTIONAL_NUMERIC:
+				LogDebug("Queueing message to %07u, type %u, func Numeric: \"%.*s\"", message->m_ric, message->m_type, message->m_length, message->m_message);
+				break;
+			case FUNCTIONAL_ALERT1:
+				LogDebug("Queueing message to %07u, type %u, func Alert 1", message->m_ric, message->m_type);
+				break;
+			default:
+				break;
+		}
+
+		PROBE3(filter_verdict, message->m_id, message->m_ric, (unsigned int)EVENT_REASON::NONE);
+
+		writeMessageEvent(EVENT_TYPE::MESSAGE_QUEUED, message);
+
+		m_trace.span(TRACE_TRACK::MESSAGES, "filter", start, "id", message->m_id);
+
+		message->m_timeInQueue.start();
+
+		unsigned int size;
+		{
+			std::lock_guard<CPriorityMutex> lock(m_mutex);
+			m_queue.push_front(message);
+			size = (unsigned int)m_queue.size();
+		}
+
+		PROBE3(message_queued, message->m_id, message->m_ric, size);
+		LogDebug("Messages in Queue %04u", size);
+	} else {
+		EVENT_REASON reason;
+		if (!found)
+			reason = EVENT_REASON::WHITELIST;
+		else if (blackListRIC)
+			reason = EVENT_REASON::BLACKLIST;
+		else if (blacklistRegexmatch)
+			reason = EVENT_REASON::BLACKLIST_REGEX;
+		else
+			reason = EVENT_REASON::WHITELIST_REGEX;
+
+		PROBE3(filter_verdict, message->m_id, message->m_ric, (unsigned int)reason);
+
+		writeMessageEvent(EVENT_TYPE::MESSAGE_FILTERED, message, reason);
+
+		m_trace.span(TRACE_TRACK::MESSAGES, "filter", start, "id", message->m_id);
+		m_trace.instant(TRACE_TRACK::MESSAGES, "filtered", "id", message->m_id);
+
+		delete message;
+	}
+}
+
+void CDAPNETGateway::setNetworks(CDAPNETNetwork* dapnetNetwork, CPOCSAGNetwork* pocsagNetwork)
+{
+	assert(dapnetNetwork != nullptr);
+	assert(pocsagNetwork != nullptr);
+
+	m_dapnetNetwork = dapnetNetwork;
+	m_pocsagNetwork = pocsagNetwork;
+	m_embedded      = true;
+}
+
+void CDAPNETGateway::stop()
+{
+	m_killed = true;
+}
+
+void CDAPNETGateway::timing()
+{
+	checkSlot();
+
+	sendMessages();
+}
+
+void CDAPNETGateway::checkSlot()
+{
+	// The MMDVM has finished sending, so the slot has been used up until now
+	if (m_mmdvmFreed.exchange(false))
+		m_sentCodewords = (m_slotClock.elapsed() * 1000U) / CODEWORD_TIME_US;
+
+	if (m_slotOffsetValid)
+		m_slotClock.setOffset(m_slotOffset);
+	m_slotClock.clock();
+
+	unsigned int slot = m_slotClock.getSlot();
+	if (slot != m_currentSlot) {
+		unsigned int current = m_currentSlot;
+
+		CTimingEvent event;
+		::memset(&event, 0x00U, sizeof(CTimingEvent));
+		event.m_type = TIMING_EVENT::SLOT;
+		event.m_slot = current;
+
+		// How long after the boundary we noticed it, except for the slot that we started in
+		if (m_slotStarted) {
+			event.m_jitter   = m_slotClock.lateness();
+			event.m_measured = true;
+			m_metrics.set(m_metrics.m_slotJitter, event.m_jitter);
+		}
+		m_slotStarted = true;
+
+		// LogDebug("Start of slot %u", slot);
+		event.m_scheduled = m_schedule != nullptr && m_schedule[current];
+		if (event.m_scheduled) {
+			m_slotStats[current].m_budget = CODEWORDS_PER_SLOT;
+			m_metrics.add(m_metrics.m_codewordsBudget, CODEWORDS_PER_SLOT);
+		}
+
+		event.m_start    = m_traceSlotStart;
+		event.m_end      = m_trace.now();
+		m_traceSlotStart = event.m_end;
+
+		addEvent(event);
+
+		// The end of a cycle, but not the partial one at startup
+		if (slot == 0U) {
+			if (m_slotStatsEnabled && m_fullCycle) {
+				std::lock_guard<CPriorityMutex> lock(m_mutex);
+				::memcpy(m_cycleStats, m_slotStats, sizeof(m_slotStats));
+				m_cycleReady = true;
+			}
+
+			::memset(m_slotStats, 0x00U, sizeof(m_slotStats));
+
+			m_fullCycle = true;
+		}
+
+		m_currentSlot = slot;
+		if (m_schedule == nullptr || slot == 0U)
+			loadSchedule();
+		m_sentCodewords = 0U;
+		m_deferredId    = 0U;
+
+		PROBE2(slot_start, slot, (m_schedule != nullptr && m_schedule[slot]) ? 1U : 0U);
+	}
+}
+
 void CDAPNETGateway::sendMessages()
 {
 	// If the MMDVM is busy, we can't send anything.
@@ -468,61 +935,320 @@ void CDAPNETGateway::sendMessages()
 		return;
 
 	// If we have data to send, see if we have time to do so in the current schedule.
-	if (m_queue.empty())
-		return;
+	// Only this side removes messages, so the oldest one can be used without the lock.
+	CPOCSAGMessage* message = nullptr;
+	{
+		std::lock_guard<CPriorityMutex> lock(m_mutex);
+		if (m_queue.empty())
+			return;
+
+		message = m_queue.back();
+	}
 
-	CPOCSAGMessage* message = m_queue.back();
 	assert(message != nullptr);
 
+	unsigned int codewords = calculateCodewords(message);
+
+	CTimingEvent event;
+
 	// Special case, only test if slots are being used.
 	if (m_allSlots) {
-		sendMessage(message);
-		m_queue.pop_back();
-		delete message;
+		bool ret = sendMessage(message, codewords, event);
+		if (ret)
+			recordAirtime(codewords);
+
+		PROBE4(send_decision, message->m_id, codewords, CODEWORDS_PER_SLOT - m_sentCodewords, (unsigned int)(ret ? PROBE_DECISION::SENT : PROBE_DECISION::NOT_SENT));
+
+		popMessage();
+		addEvent(event);
 		return;
 	}
 
-	unsigned int codewords = calculateCodewords(message);
-
 	// Do we have too much data already sent in this slot?
 	unsigned int totalCodewords = m_sentCodewords + PREAMBLE_LENGTH_CODEWORDS + codewords;
 	if (totalCodewords >= CODEWORDS_PER_SLOT) {
 		// LogDebug("Too many codewords sent in slot %u already %u + %u + %u = %u >= %u", m_currentSlot, m_sentCodewords, PREAMBLE_LENGTH_CODEWORDS, codewords, totalCodewords, CODEWORDS_PER_SLOT);
+		PROBE4(send_decision, message->m_id, codewords, CODEWORDS_PER_SLOT - m_sentCodewords, (unsigned int)PROBE_DECISION::NO_ROOM);
+		deferMessage(message);
 		return;
 	}
 
 	// Is there enough time to send it in this slot before it ends?
 	unsigned int sendTime = (PREAMBLE_TIME_US + codewords * CODEWORD_TIME_US) / 1000U;
-	unsigned int timeLeft = SLOT_TIME_MS - m_slotTimer.elapsed();
+	unsigned int timeLeft = SLOT_TIME_MS - m_slotClock.elapsed();
 	if (sendTime >= timeLeft) {
-		// LogDebug("Too little time to send the message in slot %u, %u + %u + %u = %u >= %u = %u - %u", m_currentSlot, PREAMBLE_TIME_US, codewords, CODEWORD_TIME_US, sendTime, timeLeft, SLOT_TIME_MS, m_slotTimer.elapsed());
+		// LogDebug("Too little time to send the message in slot %u, %u + %u + %u = %u >= %u = %u - %u", m_currentSlot, PREAMBLE_TIME_US, codewords, CODEWORD_TIME_US, sendTime, timeLeft, SLOT_TIME_MS, m_slotClock.elapsed());
+		PROBE4(send_decision, message->m_id, codewords, CODEWORDS_PER_SLOT - m_sentCodewords, (unsigned int)PROBE_DECISION::NO_TIME);
+		deferMessage(message);
 		return;
 	}
 
-	bool ret = sendMessage(message);
-	if (ret)
+	bool ret = sendMessage(message, codewords, event);
+	if (ret) {
 		m_sentCodewords = totalCodewords;
+		recordAirtime(codewords);
+	}
+
+	PROBE4(send_decision, message->m_id, codewords, CODEWORDS_PER_SLOT - m_sentCodewords, (unsigned int)(ret ? PROBE_DECISION::SENT : PROBE_DECISION::NOT_SENT));
+
+	// The main loop deletes the message once it has finished with the event
+	popMessage();
+	addEvent(event);
+}
+
+void CDAPNETGateway::recordAirtime(unsigned int codewords)
+{
+	m_slotStats[m_currentSlot].m_data     += codewords;
+	m_slotStats[m_currentSlot].m_preamble += PREAMBLE_LENGTH_CODEWORDS;
+	m_slotStats[m_currentSlot].m_messages++;
+
+	m_metrics.add(m_metrics.m_codewordsSent, codewords + PREAMBLE_LENGTH_CODEWORDS);
+}
+
+void CDAPNETGateway::deferMessage(const CPOCSAGMessage* message)
+{
+	assert(message != nullptr);
+
+	// The same message is tried on every pass through the loop, only count it once per slot
+	if (message->m_id == m_deferredId)
+		return;
+
+	m_slotStats[m_currentSlot].m_deferred++;
+	m_deferredId = message->m_id;
+
+	CTimingEvent event;
+	::memset(&event, 0x00U, sizeof(CTimingEvent));
+	event.m_type  = TIMING_EVENT::DEFERRED;
+	event.m_id    = message->m_id;
+	event.m_slot  = m_currentSlot;
+	event.m_start = m_trace.now();
+	addEvent(event);
+
+	m_metrics.add(m_metrics.m_deferred);
+}
+
+void CDAPNETGateway::popMessage()
+{
+	std::lock_guard<CPriorityMutex> lock(m_mutex);
 
 	m_queue.pop_back();
-	delete message;
 }
 
-bool CDAPNETGateway::recover()
+void CDAPNETGateway::addEvent(const CTimingEvent& event)
 {
+	{
+		std::lock_guard<CPriorityMutex> lock(m_mutex);
 
-	for (;;) {
-		m_dapnetNetwork->close();
-		bool ok = m_dapnetNetwork->open();
-		if (ok) {
-			ok = m_dapnetNetwork->login();
-			if (ok)
-				return true;
+		// Never grown here, that would allocate on the timing thread
+		if (m_events.size() < m_events.capacity()) {
+			m_events.push_back(event);
+			return;
+		}
+	}
+
+	// The main loop has fallen too far behind, a sent or rejected message is only referred to by its event
+	m_metrics.add(m_metrics.m_timingEventsDropped);
+	delete event.m_message;
+}
+
+void CDAPNETGateway::processEvents()
+{
+	CSlotStats slotStats[16U];
+	bool cycle = false;
+
+	{
+		std::lock_guard<CPriorityMutex> lock(m_mutex);
+
+		// Swapped rather than copied, both have room reserved so neither side allocates
+		m_events.swap(m_completed);
+
+		if (m_cycleReady) {
+			::memcpy(slotStats, m_cycleStats, sizeof(m_cycleStats));
+			m_cycleReady = false;
+			cycle = true;
+		}
+	}
+
+	for (const CTimingEvent& event : m_completed)
+		processEvent(event);
+
+	m_completed.clear();
+
+	if (cycle)
+		writeJSONSlots(slotStats);
+}
+
+void CDAPNETGateway::processEvent(const CTimingEvent& event)
+{
+	CPOCSAGMessage* message = event.m_message;
+
+	switch (event.m_type) {
+	case TIMING_EVENT::SLOT:
+		if (event.m_measured)
+			m_slotJitter.add(event.m_jitter);
+
+		if (event.m_start != 0U)
+			m_trace.span(TRACE_TRACK::SLOTS, event.m_scheduled ? "slot" : "idle slot", event.m_start, event.m_end, "slot", event.m_slot);
+		break;
+
+	case TIMING_EVENT::DEFERRED:
+		m_trace.instant(TRACE_TRACK::MESSAGES, "deferred", event.m_start, "id", event.m_id);
+		break;
+
+	case TIMING_EVENT::REJECTED:
+		assert(message != nullptr);
+
+		m_profiler.setMessage(message->m_id);
+
+		switch (message->m_functional) {
+			case FUNCTIONAL_ALPHANUMERIC:
+				LogDebug("Rejecting message to %07u, type %u, func Alphanumeric: \"%.*s\"", message->m_ric, message->m_type, message->m_length, message->m_message);
+				break;
+			case FUNCTIONAL_ALERT2:
+				LogDebug("Rejecting message to %07u, type %u, func Alert 2: \"%.*s\"", message->m_ric, message->m_type, message->m_length, message->m_message);
+				break;
+			case FUNCTIONAL_NUMERIC:
+				LogDebug("Rejecting message to %07u, type %u, func Numeric: \"%.*s\"", message->m_ric, message->m_type, message->m_length, message->m_message);
+				break;
+			case FUNCTIONAL_ALERT1:
+				LogDebug("Rejecting message to %07u, type %u, func Alert 1", message->m_ric, message->m_type);
+				break;
+			default:
+				break;
 		}
+
+		writeMessageEvent(EVENT_TYPE::MESSAGE_REJECTED, message, EVENT_REASON::STALE_TIME, event.m_slot);
+
+		m_trace.instant(TRACE_TRACK::MESSAGES, "rejected", event.m_end, "id", message->m_id);
+
+		delete message;
+		break;
+
+	case TIMING_EVENT::SENT:
+		assert(message != nullptr);
+
+		m_profiler.setMessage(message->m_id);
+
+		switch (message->m_functional) {
+			case FUNCTIONAL_ALPHANUMERIC:
+				LogMessage("Sending message in slot %u to %07u, type %u, func Alphanumeric: \"%.*s\"", event.m_slot, message->m_ric, message->m_type, message->m_length, message->m_message);
+				break;
+			case FUNCTIONAL_ALERT2:
+				LogMessage("Sending message in slot %u to %07u, type %u, func Alert 2: \"%.*s\"", event.m_slot, message->m_ric, message->m_type, message->m_length, message->m_message);
+				break;
+			case FUNCTIONAL_NUMERIC:
+				LogMessage("Sending message in slot %u to %07u, type %u, func Numeric: \"%.*s\"", event.m_slot, message->m_ric, message->m_type, message->m_length, message->m_message);
+				break;
+			case FUNCTIONAL_ALERT1:
+				LogMessage("Sending message in slot %u to %07u, type %u, func Alert 1", event.m_slot, message->m_ric, message->m_type);
+				break;
+			default:
+				break;
+		}
+
+		writeMessageEvent(EVENT_TYPE::MESSAGE_SENT, message, EVENT_REASON::NONE, event.m_slot);
+
+		m_queueWait[message->m_functional].add(event.m_queueWait);
+		m_latency[message->m_functional].add(event.m_latency);
+		m_slotWait[message->m_functional].add(event.m_slotWait);
+
+		m_topRICs.add(message->m_ric, event.m_codewords + PREAMBLE_LENGTH_CODEWORDS);
+		m_topTypes.add(message->m_type, event.m_codewords + PREAMBLE_LENGTH_CODEWORDS);
+
+		m_pocsagNetwork->writeEvent(message);
+
+		m_trace.span(TRACE_TRACK::MESSAGES, "send", event.m_start, event.m_end, "id", message->m_id);
+
+		delete message;
+		break;
+
+	default:
+		break;
+	}
+}
+
+bool CDAPNETGateway::recover()
+{
+	if (!m_reconnecting) {
+		m_metrics.add(m_metrics.m_reconnects);
+
+		m_reconnecting        = true;
+		m_reconnectFails      = 0U;
+		m_traceReconnectStart = m_trace.now();
+	} else if (m_reconnectTimer.isRunning() && !m_reconnectTimer.hasExpired()) {
+		return false;
 	}
 
+	enterStage(STAGE::RECONNECT);
+
+	m_dapnetNetwork->close();
+	bool ok = m_dapnetNetwork->open();
+	if (ok)
+		ok = m_dapnetNetwork->login();
+
+	if (ok) {
+		m_reconnecting = false;
+		m_reconnectTimer.stop();
+		m_trace.span(TRACE_TRACK::NETWORK, "reconnect", m_traceReconnectStart);
+		return true;
+	}
+
+	LogWarning("Cannot reconnect to DAPNET, trying again in %u s", BACKOFF[m_reconnectFails] / 1000U);
+
+	m_reconnectTimer.start(0U, BACKOFF[m_reconnectFails]);
+	if (m_reconnectFails < 9U)
+		m_reconnectFails++;
+
 	return false;
 }
 
+void CDAPNETGateway::checkLinkHealth()
+{
+	if (m_reconnecting)
+		return;
+
+	CTCPHealth health;
+	if (!m_dapnetNetwork->getHealth(health))
+		return;
+
+	m_metrics.set(m_metrics.m_linkRTT,              health.m_rtt);
+	m_metrics.set(m_metrics.m_linkRTTVar,           health.m_rttVar);
+	m_metrics.set(m_metrics.m_linkRetransmits,      health.m_retransmits);
+	m_metrics.set(m_metrics.m_linkTotalRetransmits, health.m_totalRetransmits);
+	m_metrics.set(m_metrics.m_linkUnacked,          health.m_unacked);
+	m_metrics.set(m_metrics.m_linkLastAck,          health.m_lastAckReceived);
+
+	unsigned int maxRTT         = m_conf.getDAPNETMaxRTT();
+	unsigned int maxRetransmits = m_conf.getDAPNETMaxRetransmits();
+	unsigned int ackTimeout     = m_conf.getDAPNETAckTimeout();
+
+	const char* reason = nullptr;
+	if (maxRTT > 0U && (health.m_rtt / 1000U) >= maxRTT)
+		reason = "the round trip time is too long";
+	else if (maxRetransmits > 0U && health.m_retransmits >= maxRetransmits)
+		reason = "a segment is being retransmitted";
+	else if (ackTimeout > 0U && health.m_unacked > 0U && health.m_lastAckReceived >= (ackTimeout * 1000U))
+		reason = "nothing has been acknowledged";
+
+	if (reason == nullptr) {
+		m_degradedSamples = 0U;
+		return;
+	}
+
+	m_degradedSamples++;
+	LogWarning("The DAPNET link has degraded, %s, rtt=%u us, retransmits=%u, unacked=%u, last ack=%u ms", reason, health.m_rtt, health.m_retransmits, health.m_unacked, health.m_lastAckReceived);
+
+	if (m_degradedSamples < m_conf.getDAPNETDegradedSamples())
+		return;
+
+	LogWarning("Reconnecting to DAPNET as the link has degraded");
+
+	m_degradedSamples = 0U;
+	m_metrics.add(m_metrics.m_linkReconnects);
+
+	recover();
+}
+
 bool CDAPNETGateway::isTimeMessage(const CPOCSAGMessage* message) const
 {
 	if (message->m_type == 5U && message->m_functional == FUNCTIONAL_NUMERIC)
@@ -562,78 +1288,94 @@ unsigned int CDAPNETGateway::calculateCodewords(const CPOCSAGMessage* message) c
 	return len;
 }
 
-void CDAPNETGateway::loadSchedule()
+void CDAPNETGateway::readSchedule()
 {
 	bool* schedule = m_dapnetNetwork->readSchedule();
 	if (schedule == nullptr)
 		return;
 
-	delete[] m_schedule;
-	m_schedule = schedule;
-
-	m_allSlots = true;
+	bool allSlots = true;
 
 	std::string text;
 	for (unsigned int i = 0U; i < 16U; i++) {
-		if (m_schedule[i]) {
+		if (schedule[i]) {
 			text += "*";
 		} else {
 			text += "-";
-			m_allSlots = false;
+			allSlots = false;
 		}
 	}
 
-	if (m_allSlots)
+	if (allSlots)
 		LogMessage("All slots are available for transmission");
 	else
 		LogMessage("Loaded new schedule: %s", text.c_str());
+
+	// Taken up by the timing side at the start of the next cycle
+	bool* old = nullptr;
+	{
+		std::lock_guard<CPriorityMutex> lock(m_mutex);
+		old = m_newSchedule;
+		m_newSchedule = schedule;
+	}
+
+	delete[] old;
+}
+
+void CDAPNETGateway::loadSchedule()
+{
+	bool* schedule = nullptr;
+	{
+		std::lock_guard<CPriorityMutex> lock(m_mutex);
+		schedule = m_newSchedule;
+		m_newSchedule = nullptr;
+	}
+
+	if (schedule == nullptr)
+		return;
+
+	delete[] m_schedule;
+	m_schedule = schedule;
+
+	m_allSlots = true;
+	for (unsigned int i = 0U; i < 16U; i++) {
+		if (!m_schedule[i])
+			m_allSlots = false;
+	}
 }
 
-bool CDAPNETGateway::sendMessage(CPOCSAGMessage* message) const
+bool CDAPNETGateway::sendMessage(CPOCSAGMessage* message, unsigned int codewords, CTimingEvent& event)
 {
 	assert(message != nullptr);
 
+	::memset(&event, 0x00U, sizeof(CTimingEvent));
+	event.m_message   = message;
+	event.m_id        = message->m_id;
+	event.m_slot      = m_currentSlot;
+	event.m_codewords = codewords;
+	event.m_start     = m_trace.now();
+
 	bool ret = isTimeMessage(message);
 	if (ret && message->m_timeQueued.elapsed() >= MAX_TIME_TO_HOLD_TIME_MESSAGES) {
-		switch (message->m_functional) {
-			case FUNCTIONAL_ALPHANUMERIC:
-				LogDebug("Rejecting message to %07u, type %u, func Alphanumeric: \"%.*s\"", message->m_ric, message->m_type, message->m_length, message->m_message);
-				break;
-			case FUNCTIONAL_ALERT2:
-				LogDebug("Rejecting message to %07u, type %u, func Alert 2: \"%.*s\"", message->m_ric, message->m_type, message->m_length, message->m_message);
-				break;
-			case FUNCTIONAL_NUMERIC:
-				LogDebug("Rejecting message to %07u, type %u, func Numeric: \"%.*s\"", message->m_ric, message->m_type, message->m_length, message->m_message);
-				break;
-			case FUNCTIONAL_ALERT1:
-				LogDebug("Rejecting message to %07u, type %u, func Alert 1", message->m_ric, message->m_type);
-				break;
-			default:
-				break;
-		}
-
+		event.m_type = TIMING_EVENT::REJECTED;
+		event.m_end  = event.m_start;
 		return false;
-	} else {
-		switch (message->m_functional) {
-			case FUNCTIONAL_ALPHANUMERIC:
-				LogMessage("Sending message in slot %u to %07u, type %u, func Alphanumeric: \"%.*s\"", m_currentSlot, message->m_ric, message->m_type, message->m_length, message->m_message);
-				break;
-			case FUNCTIONAL_ALERT2:
-				LogMessage("Sending message in slot %u to %07u, type %u, func Alert 2: \"%.*s\"", m_currentSlot, message->m_ric, message->m_type, message->m_length, message->m_message);
-				break;
-			case FUNCTIONAL_NUMERIC:
-				LogMessage("Sending message in slot %u to %07u, type %u, func Numeric: \"%.*s\"", m_currentSlot, message->m_ric, message->m_type, message->m_length, message->m_message);
-				break;
-			case FUNCTIONAL_ALERT1:
-				LogMessage("Sending message in slot %u to %07u, type %u, func Alert 1", m_currentSlot, message->m_ric, message->m_type);
-				break;
-			default:
-				break;
-		}
-
-		m_pocsagNetwork->write(message);
-		return true;
 	}
+
+	// Any of the time in the queue from before the start of this slot was spent waiting for a slot
+	unsigned int queueWait = message->m_timeInQueue.elapsed();
+	unsigned int slotTime  = m_slotClock.elapsed();
+
+	event.m_type      = TIMING_EVENT::SENT;
+	event.m_queueWait = queueWait;
+	event.m_latency   = message->m_timeQueued.elapsed();
+	event.m_slotWait  = queueWait > slotTime ? queueWait - slotTime : 0U;
+
+	m_pocsagNetwork->write(message);
+
+	event.m_end = m_trace.now();
+
+	return true;
 }
 
 void CDAPNETGateway::writeJSONStatus(const std::string& status)
@@ -646,3 +1388,241 @@ void CDAPNETGateway::writeJSONStatus(const std::string& status)
 	WriteJSON("status", json);
 }
 
+void CDAPNETGateway::writeJSONLatency()
+{
+	static const char* FUNCTIONALS[] = { "numeric", "alert1", "alert2", "alphanumeric" };
+
+	nlohmann::json json;
+
+	json["timestamp"] = CUtils::createTimestamp();
+	json["interval"]  = m_statsTimer.getTimeout();
+
+	nlohmann::json queueWait = nlohmann::json::object();
+	nlohmann::json latency   = nlohmann::json::object();
+	nlohmann::json slotWait  = nlohmann::json::object();
+
+	// Only include the functional types that have been sent
+	for (unsigned int i = 0U; i < 4U; i++) {
+		if (m_latency[i].getCount() == 0U)
+			continue;
+
+		m_queueWait[i].write(queueWait[FUNCTIONALS[i]]);
+		m_latency[i].write(latency[FUNCTIONALS[i]]);
+		m_slotWait[i].write(slotWait[FUNCTIONALS[i]]);
+
+		m_queueWait[i].reset();
+		m_latency[i].reset();
+		m_slotWait[i].reset();
+	}
+
+	json["queue_wait"] = queueWait;
+	json["latency"]    = latency;
+	json["slot_wait"]  = slotWait;
+
+	// To compare the jitter with and without the timing thread
+	json["timing"] = m_timingThread != nullptr ? "thread" : "main";
+	m_slotJitter.write(json["slot_jitter"]);
+	m_slotJitter.reset();
+
+	WriteJSON("latency", json);
+}
+
+void CDAPNETGateway::writeJSONSlots(const CSlotStats* slotStats)
+{
+	assert(slotStats != nullptr);
+
+	nlohmann::json json;
+
+	json["timestamp"] = CUtils::createTimestamp();
+
+	CSlotStats total;
+	::memset(&total, 0x00U, sizeof(CSlotStats));
+
+	nlohmann::json slots = nlohmann::json::array();
+	for (unsigned int i = 0U; i < 16U; i++) {
+		const CSlotStats& stats = slotStats[i];
+
+		unsigned int used = stats.m_data + stats.m_preamble;
+
+		nlohmann::json slot;
+		slot["budget"]   = stats.m_budget;
+		slot["data"]     = stats.m_data;
+		slot["preamble"] = stats.m_preamble;
+		slot["idle"]     = stats.m_budget > used ? stats.m_budget - used : 0U;
+		slot["messages"] = stats.m_messages;
+		slot["deferred"] = stats.m_deferred;
+		slots.push_back(slot);
+
+		total.m_budget   += stats.m_budget;
+		total.m_data     += stats.m_data;
+		total.m_preamble += stats.m_preamble;
+		total.m_messages += stats.m_messages;
+		total.m_deferred += stats.m_deferred;
+	}
+
+	unsigned int used = total.m_data + total.m_preamble;
+
+	json["slots"]    = slots;
+	json["budget"]   = total.m_budget;
+	json["data"]     = total.m_data;
+	json["preamble"] = total.m_preamble;
+	json["idle"]     = total.m_budget > used ? total.m_budget - used : 0U;
+	json["messages"] = total.m_messages;
+	json["deferred"] = total.m_deferred;
+
+	// If messages had to wait for room then more slots would have helped
+	json["limit"]    = total.m_deferred > 0U ? "schedule" : "traffic";
+
+	WriteJSON("slots", json);
+}
+
+void CDAPNETGateway::writeJSONTop()
+{
+	nlohmann::json json;
+
+	json["timestamp"] = CUtils::createTimestamp();
+	json["interval"]  = m_topTimer.getTimeout();
+
+	m_topRICs.write(json["rics"], "ric", m_topCount);
+	m_topTypes.write(json["types"], "type", m_topCount);
+
+	m_topRICs.reset();
+	m_topTypes.reset();
+
+	WriteJSON("airtime", json);
+}
+
+void CDAPNETGateway::updateMetrics()
+{
+	m_metrics.add(m_metrics.m_loops);
+
+	unsigned int size;
+	{
+		std::lock_guard<CPriorityMutex> lock(m_mutex);
+		size = (unsigned int)m_queue.size();
+	}
+
+	m_metrics.set(m_metrics.m_queueDepth,   size);
+	m_metrics.set(m_metrics.m_currentSlot,  m_currentSlot.load());
+	m_metrics.set(m_metrics.m_mmdvmFree,    m_mmdvmFree.load());
+	if (m_mqtt != nullptr) {
+		m_metrics.set(m_metrics.m_mqttBuffered,     m_mqtt->getBuffered());
+		m_metrics.set(m_metrics.m_mqttDropped,      m_mqtt->getDropped());
+		m_metrics.set(m_metrics.m_mqttReplayed,     m_mqtt->getReplayed());
+		m_metrics.set(m_metrics.m_mqttRecords,      m_mqtt->getRecords());
+		m_metrics.set(m_metrics.m_mqttRecordBytes,  m_mqtt->getRecordBytes());
+		m_metrics.set(m_metrics.m_mqttMessages,     m_mqtt->getMessages());
+		m_metrics.set(m_metrics.m_mqttMessageBytes, m_mqtt->getMessageBytes());
+	}
+
+	if (m_injector != nullptr)
+		m_metrics.set(m_metrics.m_injectedDropped, m_injector->getInvalid() + m_injector->getOverQuota() + m_injector->getQueueFull());
+
+	const CTimeSync& sync = m_dapnetNetwork->getTimeSync();
+	m_metrics.set(m_metrics.m_timeOffset,     sync.getOffset());
+	m_metrics.set(m_metrics.m_timeRTT,        sync.getRTT());
+	m_metrics.set(m_metrics.m_timeDrift,      sync.getDrift());
+	m_metrics.set(m_metrics.m_timeCorrection, sync.getCorrection());
+}
+
+void CDAPNETGateway::toggleProfiler()
+{
+	if (m_profiler.isEnabled()) {
+		writeJSONProfile();
+		m_profiler.setEnabled(false);
+		m_profileTimer.stop();
+		LogMessage("Stage profiling is disabled");
+	} else {
+		m_profiler.reset();
+		m_profiler.setEnabled(true);
+		if (m_conf.getProfilerInterval() > 0U)
+			m_profileTimer.start();
+		LogMessage("Stage profiling is enabled");
+	}
+}
+
+void CDAPNETGateway::writeJSONProfile()
+{
+	nlohmann::json json;
+
+	json["timestamp"] = CUtils::createTimestamp();
+	json["interval"]  = m_profileTimer.getTimeout();
+
+	m_profiler.write(json["stages"]);
+	m_profiler.reset();
+
+	WriteJSON("profile", json);
+}
+
+void CDAPNETGateway::enterStage(STAGE stage)
+{
+	if (m_watchdog != nullptr)
+		m_watchdog->enter(stage);
+}
+
+void CDAPNETGateway::writeTrace()
+{
+	if (!m_trace.isEnabled())
+		return;
+
+	time_t now;
+	::time(&now);
+
+	struct tm* tm = ::gmtime(&now);
+
+	char fileName[100U];
+	::snprintf(fileName, 100U, "dapnetgateway-%04d%02d%02d-%02d%02d%02d.json", tm->tm_year + 1900, tm->tm_mon + 1, tm->tm_mday, tm->tm_hour, tm->tm_min, tm->tm_sec);
+
+	m_trace.write(m_conf.getTraceDirectory() + "/" + fileName);
+}
+
+void CDAPNETGateway::writeMessageEvent(EVENT_TYPE type, const CPOCSAGMessage* message, EVENT_REASON reason, unsigned char slot)
+{
+	assert(message != nullptr);
+
+	::EventMessage(type, message, reason, slot);
+
+	switch (type) {
+	case EVENT_TYPE::MESSAGE_RECEIVED:
+		m_metrics.add(m_metrics.m_received);
+		break;
+	case EVENT_TYPE::MESSAGE_FILTERED:
+		m_metrics.add(m_metrics.m_filtered);
+		break;
+	case EVENT_TYPE::MESSAGE_QUEUED:
+		m_metrics.add(m_metrics.m_queued);
+		break;
+	case EVENT_TYPE::MESSAGE_SENT:
+		m_metrics.add(m_metrics.m_sent);
+		break;
+	case EVENT_TYPE::MESSAGE_REJECTED:
+		m_metrics.add(m_metrics.m_rejected);
+		break;
+	default:
+		break;
+	}
+
+	if (!m_messageEvents)
+		return;
+
+	nlohmann::json json;
+
+	// The monotonic time and the age allow latencies to be calculated without worrying about clock changes
+	json["timestamp"]  = CUtils::createTimestamp();
+	json["monotonic"]  = CClock::get().monotonic() / 1000ULL;
+	json["event"]      = ::EventTypeName(type);
+	json["id"]         = message->m_id;
+	json["ric"]        = message->m_ric;
+	json["type"]       = message->m_type;
+	json["functional"] = message->m_functional;
+	json["age"]        = message->m_timeQueued.elapsed();
+
+	if (reason != EVENT_REASON::NONE)
+		json["reason"] = ::EventReasonName(reason);
+
+	if (type == EVENT_TYPE::MESSAGE_SENT || type == EVENT_TYPE::MESSAGE_REJECTED)
+		json["slot"] = slot;
+
+	WriteJSON("message", json);
+}
+
@@ -1,5 +1,5 @@
 /*
-*   Copyright (C) 2018,2023 by Jonathan Naylor G4KLX
+*   Copyright (C) 2018,2023,2026 by Jonathan Naylor G4KLX
 *
 *   This program is free software; you can redistribute it and/or modify
 *   it under the terms of the GNU General Public License as published by
@@ -21,8 +21,21 @@
 
 #include "DAPNETNetwork.h"
 #include "POCSAGNetwork.h"
+#include "SpoolDirectory.h"
+#include "MetricsServer.h"
+#include "StatsPage.h"
+#include "StageProfiler.h"
+#include "TraceRecorder.h"
+#include "Watchdog.h"
+#include "TimingThread.h"
+#include "EventLog.h"
 #include "POCSAGMessage.h"
+#include "SlotClock.h"
 #include "StopWatch.h"
+#include "HeavyHitters.h"
+#include "Histogram.h"
+#include "Metrics.h"
+#include "Timer.h"
 #include "Conf.h"
 #include "REGEX.h"
 
@@ -30,6 +43,42 @@
 #include <deque>
 #include <vector>
 #include <regex>
+#include <mutex>
+#include <atomic>
+
+// The airtime in one slot, all in codewords
+struct CSlotStats {
+	unsigned int m_budget;
+	unsigned int m_data;
+	unsigned int m_preamble;
+	unsigned int m_messages;
+	unsigned int m_deferred;
+};
+
+enum class TIMING_EVENT {
+	SLOT,			// A slot has ended
+	SENT,
+	REJECTED,
+	DEFERRED
+};
+
+// What the timing thread has done, handed to the main loop to log, trace and
+// write out, so that the timing thread never waits on files or the network
+struct CTimingEvent {
+	TIMING_EVENT    m_type;
+	CPOCSAGMessage* m_message;		// Owned by the event when sent or rejected
+	unsigned int    m_id;
+	unsigned int    m_slot;
+	bool            m_scheduled;
+	bool            m_measured;		// Whether there is a jitter
+	unsigned int    m_jitter;
+	unsigned int    m_codewords;
+	unsigned int    m_queueWait;
+	unsigned int    m_latency;
+	unsigned int    m_slotWait;
+	uint64_t        m_start;
+	uint64_t        m_end;
+};
 
 class CDAPNETGateway
 {
@@ -39,29 +88,105 @@ public:
 
 	int run();
 
+	// The slot boundaries and sending, from the timing thread
+	void timing();
+
+	// Run inside another program, such as dapnetsim, with networks that
+	// the gateway then owns. There is no daemon, MQTT, watchdog or timing
+	// thread, and the caller initialises the logging.
+	void setNetworks(CDAPNETNetwork* dapnetNetwork, CPOCSAGNetwork* pocsagNetwork);
+
+	void stop();
+
 private:
 	CConf                       m_conf;
 	CDAPNETNetwork*             m_dapnetNetwork;
 	CPOCSAGNetwork*             m_pocsagNetwork;
 	std::deque<CPOCSAGMessage*> m_queue;
-	CStopWatch                  m_slotTimer;
+	CSlotClock                  m_slotClock;
+	bool                        m_slotStarted;
 	bool*                       m_schedule;
 	bool                        m_allSlots;
-	unsigned int                m_currentSlot;
+	bool*                       m_newSchedule;
+	std::atomic<unsigned int>   m_currentSlot;
 	unsigned int                m_sentCodewords;
 	CREGEX*                     m_regexBlacklist;
 	CREGEX*                     m_regexWhitelist;
-	bool                        m_mmdvmFree;
+	std::vector<unsigned int>   m_whiteList;
+	std::vector<unsigned int>   m_blackList;
+	std::vector<std::regex>     m_blacklistRegexes;
+	std::vector<std::regex>     m_whitelistRegexes;
+	CSpoolDirectory*            m_spool;
+	bool                        m_messageEvents;
+	CHistogram                  m_queueWait[4U];
+	CHistogram                  m_latency[4U];
+	CHistogram                  m_slotWait[4U];
+	CHistogram                  m_slotJitter;
+	CTimer                      m_statsTimer;
+	bool                        m_slotStatsEnabled;
+	CSlotStats                  m_slotStats[16U];
+	CSlotStats                  m_cycleStats[16U];
+	bool                        m_cycleReady;
+	unsigned int                m_deferredId;
+	bool                        m_fullCycle;
+	CHeavyHitters               m_topRICs;
+	CHeavyHitters               m_topTypes;
+	CTimer                      m_topTimer;
+	unsigned int                m_topCount;
+	CMetrics                    m_metrics;
+	CMetricsServer*             m_metricsServer;
+	CStatsPage*                 m_statsPage;
+	CStageProfiler              m_profiler;
+	CTimer                      m_profileTimer;
+	CTraceRecorder              m_trace;
+	uint64_t                    m_traceSlotStart;
+	uint64_t                    m_traceBusyStart;
+	CWatchdog*                  m_watchdog;
+	CTimer                      m_healthTimer;
+	unsigned int                m_degradedSamples;
+	bool                        m_reconnecting;
+	CTimer                      m_reconnectTimer;
+	unsigned int                m_reconnectFails;
+	uint64_t                    m_traceReconnectStart;
+	bool                        m_timeSync;
+	CPriorityMutex              m_mutex;
+	std::vector<CTimingEvent>   m_events;
+	std::vector<CTimingEvent>   m_completed;
+	std::atomic<int>            m_slotOffset;
+	std::atomic<bool>           m_slotOffsetValid;
+	CTimingThread*              m_timingThread;
+	bool                        m_embedded;
+	std::atomic<bool>           m_mmdvmFree;
+	std::atomic<bool>           m_mmdvmFreed;
 
 
+	void admitMessage(CPOCSAGMessage* message);
+	void checkSlot();
 	void sendMessages();
+	void recordAirtime(unsigned int codewords);
+	void deferMessage(const CPOCSAGMessage* message);
 	bool recover();
+	void checkLinkHealth();
 	bool isTimeMessage(const CPOCSAGMessage* message) const;
 	unsigned int calculateCodewords(const CPOCSAGMessage* message) const;
+	void readSchedule();
 	void loadSchedule();
-	bool sendMessage(CPOCSAGMessage* message) const;
+	bool sendMessage(CPOCSAGMessage* message, unsigned int codewords, CTimingEvent& event);
+	void popMessage();
+	void addEvent(const CTimingEvent& event);
+	void processEvents();
+	void processEvent(const CTimingEvent& event);
 
 	void writeJSONStatus(const std::string& status);
+	void writeJSONLatency();
+	void writeJSONSlots(const CSlotStats* slotStats);
+	void writeJSONTop();
+	void updateMetrics();
+	void toggleProfiler();
+	void writeJSONProfile();
+	void writeTrace();
+	void enterStage(STAGE stage);
+	void writeMessageEvent(EVENT_TYPE type, const CPOCSAGMessage* message, EVENT_REASON reason = EVENT_REASON::NONE, unsigned char slot = 0U);
 };
 
 #endif
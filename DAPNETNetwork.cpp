@@ -1,5 +1,5 @@
 /*
- *   Copyright (C) 2018,2025 by Jonathan Naylor G4KLX
+ *   Copyright (C) 2018,2025,2026 by Jonathan Naylor G4KLX
  *
  *   This program is free software; you can redistribute it and/or modify
  *   it under the terms of the GNU General Public License as published by
@@ -17,6 +17,10 @@
  */
 
 #include "DAPNETNetwork.h"
+#include "EventLog.h"
+#include "Capture.h"
+#include "Clock.h"
+#include "Probes.h"
 #include "Thread.h"
 #include "Utils.h"
 #include "Log.h"
@@ -27,11 +31,11 @@
 #include <cassert>
 #include <cstring>
 
-const unsigned int BACKOFF[] = { 2000U, 4000U, 8000U, 10000U, 20000U, 60000U, 120000U, 240000U, 480000U, 600000U };
-
 const unsigned int BUFFER_LENGTH = 200U;
 
-CDAPNETNetwork::CDAPNETNetwork(const std::string& address, unsigned short port, const std::string& callsign, const std::string& authKey, const char* version, bool loggedIn, int failCount, bool debug) :
+const unsigned int TIME_REPLY_LENGTH = 8U;		// :XXXX, CR, LF and the NUL
+
+CDAPNETNetwork::CDAPNETNetwork(const std::string& address, unsigned short port, const std::string& callsign, const std::string& authKey, const char* version, bool loggedIn, int failCount, bool debug, bool timeSync) :
 m_socket(address, port),
 m_callsign(callsign),
 m_authKey(authKey),
@@ -39,6 +43,8 @@ m_version(version),
 m_loggedIn(false),
 m_failCount(failCount),
 m_debug(debug),
+m_timeSync(timeSync),
+m_sync(),
 m_message(nullptr),
 m_schedule(nullptr)
 {
@@ -57,7 +63,7 @@ bool CDAPNETNetwork::open()
 {
 	LogMessage("Opening DAPNET connection");
 
-	return m_socket.open();
+	return connect();
 }
 
 bool CDAPNETNetwork::login()
@@ -76,14 +82,18 @@ bool CDAPNETNetwork::read()
 {
 	unsigned char buffer[BUFFER_LENGTH];
 
-	int length = m_socket.read(buffer, BUFFER_LENGTH, 0U);
-	if (length == -1)		// Error
-		return false;
-	if (length == -2)		// Connection lost
+	int length = receive(buffer, BUFFER_LENGTH - 1U);
+	if (length == -1 || length == -2) {
+		// An error or the connection was lost
+		::CaptureFrame(CAPTURE_TYPE::DAPNET_LOST, nullptr, 0U);
 		return false;
+	}
 	if (length == 0)
 		return true;
 
+	::CaptureFrame(CAPTURE_TYPE::DAPNET_RX, buffer, length);
+	::EventFrame(EVENT_TYPE::DAPNET_RX, buffer, length);
+
 	if (m_debug)
 		CUtils::dump(1U, "DAPNET Data Received", buffer, length);
 
@@ -102,20 +112,10 @@ bool CDAPNETNetwork::read()
 			LogMessage("Logged into the DAPNET network");
 		}
 		// Time synchronisation
-		char* p = ::strchr((char*)buffer, '\n');
-		if (p != nullptr)
-			::strcpy(p, ":0000\r\n");
-		else
-			::strcat((char*)buffer, ":0000\r\n");
-
-		bool ok = write(buffer);
-		if (!ok)
-			return false;
-
-		return write((unsigned char*)"+\r\n");
+		return parseTimeSync(buffer, BUFFER_LENGTH);
 	} else if (buffer[0U] == '3') {
-		// ???
-		return write((unsigned char*)"+\r\n");
+		// Time correction
+		return parseTimeCorrection(buffer);
 	} else if (buffer[0U] == '4') {
 		// Timeslot information
 		return parseSchedule(buffer);
@@ -154,25 +154,61 @@ CPOCSAGMessage* CDAPNETNetwork::readMessage()
 	return message;
 }
 
+bool CDAPNETNetwork::getHealth(CTCPHealth& health) const
+{
+	return m_socket.getHealth(health);
+}
+
+const CTimeSync& CDAPNETNetwork::getTimeSync() const
+{
+	return m_sync;
+}
+
 void CDAPNETNetwork::close()
 {
-	m_socket.close();
+	disconnect();
 
 	LogMessage("Closing DAPNET connection");
 }
 
+bool CDAPNETNetwork::connect()
+{
+	return m_socket.open();
+}
+
+int CDAPNETNetwork::receive(unsigned char* buffer, unsigned int length)
+{
+	assert(buffer != nullptr);
+
+	return m_socket.read(buffer, length, 0U);
+}
+
+bool CDAPNETNetwork::send(const unsigned char* data, unsigned int length)
+{
+	assert(data != nullptr);
+
+	return m_socket.write(data, length);
+}
+
+void CDAPNETNetwork::disconnect()
+{
+	m_socket.close();
+}
+
 bool CDAPNETNetwork::write(unsigned char* data)
 {
 	assert(data != nullptr);
 
 	unsigned int length = (unsigned int)::strlen((char*)data);
 
+	::EventFrame(EVENT_TYPE::DAPNET_TX, data, length);
+
 	if (m_debug)
 		CUtils::dump(1U, "DAPNET Data Transmitted", data, length);
 
-	bool ok = m_socket.write(data, length);
+	bool ok = send(data, length);
 	if (!ok)
-		LogWarning("Error when writing to DAPNET");
+		LogWarningLimited("Error when writing to DAPNET");
 
 	return ok;
 }
@@ -204,6 +240,8 @@ bool CDAPNETNetwork::parseMessage(unsigned char* buffer, unsigned int length)
 
 		m_message = new CPOCSAGMessage(type, addr, func, (unsigned char*)p5, (unsigned int)::strlen(p5));
 
+		PROBE5(message_parsed, m_message->m_id, m_message->m_ric, m_message->m_type, m_message->m_functional, m_message->m_length);
+
 		id = (id + 1U) % 256UL;
 
 		char reply[20U];
@@ -272,9 +310,51 @@ bool CDAPNETNetwork::parseFailedLogin(unsigned char* data)
 
 	LogMessage("Login failed: %s", p);
 
-	CThread::sleep(BACKOFF[m_failCount]);
+	CClock::get().sleep(BACKOFF[m_failCount]);
 	if (m_failCount < 9)
 		m_failCount++;
 
 	return write((unsigned char*)"+\r\n");
 }
+
+bool CDAPNETNetwork::parseTimeSync(unsigned char* data, unsigned int size)
+{
+	assert(data != nullptr);
+
+	// The core's time in deciseconds
+	unsigned int coreTime = (unsigned int)::strtoul((char*)data + 2U, nullptr, 16);
+	unsigned int ourTime  = m_sync.request(coreTime);
+
+	// Our time replaces the line ending, the line is cut short if there isn't room for it.
+	// Without time sync we report a time of zero as we always have
+	unsigned int length = (unsigned int)::strcspn((char*)data, "\r\n");
+	if (length > (size - TIME_REPLY_LENGTH))
+		length = size - TIME_REPLY_LENGTH;
+
+	::snprintf((char*)data + length, size - length, ":%04X\r\n", m_timeSync ? ourTime : 0U);
+
+	bool ok = write(data);
+	if (!ok)
+		return false;
+
+	m_sync.replied();
+
+	return write((unsigned char*)"+\r\n");
+}
+
+bool CDAPNETNetwork::parseTimeCorrection(unsigned char* data)
+{
+	assert(data != nullptr);
+
+	// In the form 3:+XXXX, in deciseconds
+	const char* p = (char*)data + 2U;
+
+	bool negative = *p == '-';
+	if (*p == '+' || *p == '-')
+		p++;
+
+	int correction = int(::strtoul(p, nullptr, 16));
+	m_sync.correction(negative ? -correction : correction);
+
+	return write((unsigned char*)"+\r\n");
+}
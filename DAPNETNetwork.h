@@ -1,5 +1,5 @@
 /*
- *   Copyright (C) 2018 by Jonathan Naylor G4KLX
+ *   Copyright (C) 2018,2026 by Jonathan Naylor G4KLX
  *
  *   This program is free software; you can redistribute it and/or modify
  *   it under the terms of the GNU General Public License as published by
@@ -21,15 +21,19 @@
 
 #include "POCSAGMessage.h"
 #include "TCPSocket.h"
+#include "TimeSync.h"
 #include "Timer.h"
 
 #include <cstdint>
 #include <string>
 
+// The waits in ms after successive failures to log in or connect
+const unsigned int BACKOFF[] = { 2000U, 4000U, 8000U, 10000U, 20000U, 60000U, 120000U, 240000U, 480000U, 600000U };
+
 class CDAPNETNetwork {
 public:
-	CDAPNETNetwork(const std::string& address, unsigned short port, const std::string& callsign, const std::string& authKey, const char* version, bool loggedIn, int failCount, bool debug);
-	~CDAPNETNetwork();
+	CDAPNETNetwork(const std::string& address, unsigned short port, const std::string& callsign, const std::string& authKey, const char* version, bool loggedIn, int failCount, bool debug, bool timeSync);
+	virtual ~CDAPNETNetwork();
 
 	bool open();
 
@@ -41,8 +45,19 @@ public:
 
 	CPOCSAGMessage* readMessage();
 
+	bool getHealth(CTCPHealth& health) const;
+
+	const CTimeSync& getTimeSync() const;
+
 	void close();
 
+protected:
+	// The TCP connection to the core, overridden by dapnetsim
+	virtual bool connect();
+	virtual int  receive(unsigned char* buffer, unsigned int length);
+	virtual bool send(const unsigned char* data, unsigned int length);
+	virtual void disconnect();
+
 private:
 	CTCPSocket      m_socket;
 	std::string     m_callsign;
@@ -51,12 +66,16 @@ private:
 	bool            m_loggedIn;
 	int             m_failCount;
 	bool            m_debug;
+	bool            m_timeSync;
+	CTimeSync       m_sync;
 	CPOCSAGMessage* m_message;
 	bool*           m_schedule;
 
 	bool parseMessage(unsigned char* data, unsigned int length);
 	bool parseSchedule(unsigned char* data);
 	bool parseFailedLogin(unsigned char* data);
+	bool parseTimeSync(unsigned char* data, unsigned int size);
+	bool parseTimeCorrection(unsigned char* data);
 	bool write(unsigned char* data);
 };
 
@@ -0,0 +1,818 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+// Runs the gateway's real admission and scheduling code against a simulated
+// DAPNET core and MMDVM on a virtual clock, to compare configurations offline.
+// It can also replay a capture made by the gateway, at full speed or in real
+// time, to reproduce what happened with the traffic from a real session.
+
+#include "DAPNETGateway.h"
+#include "DAPNETNetwork.h"
+#include "POCSAGNetwork.h"
+#include "Capture.h"
+#include "Histogram.h"
+#include "Clock.h"
+#include "Log.h"
+
+#include <string>
+#include <deque>
+#include <map>
+#include <random>
+#include <chrono>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+
+static const char* USAGE = "Usage: dapnetsim [-H hours] [-r pages/hour] [-a alpha%] [-l length] [-s slots] [-b busy%] [-S seed] [-t trace] [-R capture [-x]] [-v] [filename]\n";
+
+#if defined(_WIN32) || defined(_WIN64)
+static const char* DEFAULT_INI_FILE = "DAPNETGateway.ini";
+#else
+static const char* DEFAULT_INI_FILE = "/etc/DAPNETGateway.ini";
+#endif
+
+// 2026-01-01 00:00:00 UTC, so that runs are repeatable
+static const unsigned long long START_TIME_MS = 1767225600000ULL;
+
+static const double CODEWORD_TIME_MS = 32.0 / 1.2;		// 1200 bps
+static const unsigned int PREAMBLE_CODEWORDS = 18U;		// 576 bits of preamble
+static const unsigned int BATCH_CODEWORDS = 17U;		// Sync and eight frames
+static const unsigned int SLOT_MS = 6400U;
+
+static const unsigned int BUSY_MEAN_MS = 60000U;		// The mean length of a spell in another mode
+
+static const unsigned int REPLAY_TAIL_MS = 60000U;		// After the end of a capture, to send what is queued
+
+struct CSimArrival {
+	unsigned long long m_time;
+	std::string        m_line;
+};
+
+// What was offered to the gateway and what the simulated MMDVM sent
+class CSimResults {
+public:
+	CSimResults() :
+	m_arrived(0U),
+	m_sent(0U),
+	m_transmitted(0U),
+	m_codewords(0ULL),
+	m_inSchedule(0.0),
+	m_outSchedule(0.0),
+	m_busy(0ULL),
+	m_backlog(0.0),
+	m_latency(),
+	m_waiting()
+	{
+	}
+
+	unsigned int       m_arrived;
+	unsigned int       m_sent;
+	unsigned int       m_transmitted;		// Before the end of the run
+	unsigned long long m_codewords;
+	double             m_inSchedule;		// In ms
+	double             m_outSchedule;		// In ms
+	unsigned long long m_busy;			// In ms
+	double             m_backlog;			// In ms, still to be sent at the end
+	CHistogram         m_latency;
+	std::map<std::string, std::deque<unsigned long long>> m_waiting;
+};
+
+static unsigned long long now()
+{
+	return CClock::get().wall() / 1000000ULL;
+}
+
+// Microseconds on the monotonic clock, for the replay of captures
+static unsigned long long monotonic()
+{
+	return CClock::get().monotonic() / 1000ULL;
+}
+
+// Keyed by the RIC and text, as that is what reaches the MMDVM
+static void recordArrival(CSimResults& results, const std::string& page, unsigned long long time)
+{
+	// type:speed:ric:functional:text
+	unsigned int type, speed, ric, functional;
+	int n = 0;
+	if (::sscanf(page.c_str(), "%u:%u:%x:%u:%n", &type, &speed, &ric, &functional, &n) != 4)
+		return;
+
+	char key[20U];
+	::snprintf(key, 20U, "%u:", ric);
+
+	results.m_waiting[std::string(key) + page.substr(n)].push_back(time);
+	results.m_arrived++;
+}
+
+static bool parseSlots(const std::string& text, bool* slots)
+{
+	for (unsigned int i = 0U; i < 16U; i++)
+		slots[i] = false;
+
+	for (std::string::const_iterator it = text.begin(); it != text.end(); ++it) {
+		char c = *it;
+		if (c >= '0' && c <= '9')
+			slots[c - '0'] = true;
+		else if (c >= 'A' && c <= 'F')
+			slots[c - 'A' + 10] = true;
+		else if (c >= 'a' && c <= 'f')
+			slots[c - 'a' + 10] = true;
+		else
+			return false;
+	}
+
+	return true;
+}
+
+// Feeds the gateway the login replies, the schedule and the pages as DAPNET
+// protocol lines, so that they go through the real parsing
+class CSimDAPNETNetwork : public CDAPNETNetwork {
+public:
+	CSimDAPNETNetwork(CSimResults& results, const std::string& slots, unsigned long long end) :
+	CDAPNETNetwork("127.0.0.1", 1U, "sim", "sim", "sim", false, 1, false, false),
+	m_results(results),
+	m_slots(slots),
+	m_end(end),
+	m_gateway(nullptr),
+	m_control(),
+	m_arrivals(),
+	m_id(0U)
+	{
+	}
+
+	void setGateway(CDAPNETGateway* gateway)
+	{
+		m_gateway = gateway;
+	}
+
+	void add(const CSimArrival& arrival)
+	{
+		m_arrivals.push_back(arrival);
+	}
+
+protected:
+	virtual bool connect()
+	{
+		return true;
+	}
+
+	virtual int receive(unsigned char* buffer, unsigned int length)
+	{
+		unsigned long long time = now();
+
+		if (time >= m_end) {
+			if (m_gateway != nullptr)
+				m_gateway->stop();
+			return 0;
+		}
+
+		std::string line;
+		if (!m_control.empty()) {
+			line = m_control.front();
+			m_control.pop_front();
+		} else if (!m_arrivals.empty() && m_arrivals.front().m_time <= time) {
+			const std::string& page = m_arrivals.front().m_line;
+
+			char id[10U];
+			::snprintf(id, 10U, "#%02X ", m_id);
+			m_id = (m_id + 1U) % 256U;
+
+			line = std::string(id) + page + "\n";
+
+			recordArrival(m_results, page, time);
+
+			m_arrivals.pop_front();
+		} else {
+			return 0;
+		}
+
+		if (line.size() > length)
+			line.resize(length);
+
+		::memcpy(buffer, line.c_str(), line.size());
+
+		return int(line.size());
+	}
+
+	virtual bool send(const unsigned char* data, unsigned int)
+	{
+		// The login, reply with a time sync, which logs us in, and the schedule
+		if (data[0U] == '[') {
+			char line[20U];
+			::snprintf(line, 20U, "2:%04X\n", (unsigned int)((now() / 100ULL) & 0xFFFFULL));
+			m_control.push_back(line);
+			m_control.push_back("4:" + m_slots + "\n");
+		}
+
+		return true;
+	}
+
+	virtual void disconnect()
+	{
+	}
+
+private:
+	CSimResults&            m_results;
+	std::string             m_slots;
+	unsigned long long      m_end;
+	CDAPNETGateway*         m_gateway;
+	std::deque<std::string> m_control;
+	std::deque<CSimArrival> m_arrivals;
+	unsigned int            m_id;
+};
+
+// Feeds the gateway the bytes captured from a real DAPNET connection, each
+// read as it was made, and at the same time from the start. The replies from
+// the gateway are dropped as the core's side of the session is fixed.
+class CReplayDAPNETNetwork : public CDAPNETNetwork {
+public:
+	CReplayDAPNETNetwork(CSimResults& results, unsigned long long end) :
+	CDAPNETNetwork("127.0.0.1", 1U, "sim", "sim", "sim", false, 1, false, false),
+	m_results(results),
+	m_end(end),
+	m_gateway(nullptr),
+	m_records(),
+	m_base(0ULL),
+	m_lost(0U)
+	{
+	}
+
+	void setGateway(CDAPNETGateway* gateway)
+	{
+		m_gateway = gateway;
+	}
+
+	void add(const CCaptureRecord& record)
+	{
+		m_records.push_back(record);
+	}
+
+	void start(unsigned long long base)
+	{
+		m_base = base;
+	}
+
+	unsigned int getLost() const
+	{
+		return m_lost;
+	}
+
+protected:
+	virtual bool connect()
+	{
+		return true;
+	}
+
+	virtual int receive(unsigned char* buffer, unsigned int length)
+	{
+		if (now() >= m_end) {
+			if (m_gateway != nullptr)
+				m_gateway->stop();
+			return 0;
+		}
+
+		if (m_records.empty() || (m_base + m_records.front().m_time) > monotonic())
+			return 0;
+
+		CCaptureRecord record = m_records.front();
+		m_records.pop_front();
+
+		if (record.m_type == CAPTURE_TYPE::DAPNET_LOST) {
+			m_lost++;
+			return -2;
+		}
+
+		unsigned int n = (unsigned int)record.m_data.size();
+		if (n > length)
+			n = length;
+
+		::memcpy(buffer, record.m_data.data(), n);
+
+		// A page, in the form #XX type:speed:ric:functional:text
+		if (n > 4U && buffer[0U] == '#') {
+			std::string page((const char*)buffer + 4U, n - 4U);
+			std::string::size_type pos = page.find_first_of("\r\n");
+			if (pos != std::string::npos)
+				page.resize(pos);
+
+			recordArrival(m_results, page, now());
+		}
+
+		return int(n);
+	}
+
+	virtual bool send(const unsigned char*, unsigned int)
+	{
+		return true;
+	}
+
+	virtual void disconnect()
+	{
+	}
+
+private:
+	CSimResults&               m_results;
+	unsigned long long         m_end;
+	CDAPNETGateway*            m_gateway;
+	std::deque<CCaptureRecord> m_records;
+	unsigned long long         m_base;
+	unsigned int               m_lost;
+};
+
+// Takes the POCSAG frames from the gateway and sends them as an MMDVM would,
+// a preamble when the transmitter comes on, and then each message in whole
+// batches with the address in the frame given by the bottom of the RIC. It
+// can also spend some of the time in other modes, when it is busy.
+class CSimMMDVM : public CPOCSAGNetwork {
+public:
+	CSimMMDVM(CSimResults& results, const bool* slots, unsigned int busy, unsigned int seed, unsigned long long end) :
+	CPOCSAGNetwork("127.0.0.1", 0U, "127.0.0.1", 1U, false),
+	m_results(results),
+	m_slots(slots),
+	m_end(end),
+	m_busy(busy),
+	m_random(seed + 1U),
+	m_txEnd(0.0),
+	m_reported(false),
+	m_free(true),
+	m_lastFree(true),
+	m_change(0ULL),
+	m_busyStart(0ULL),
+	m_replay(false),
+	m_status(),
+	m_base(0ULL)
+	{
+		m_change = START_TIME_MS + nextChange(true);
+	}
+
+	// Report the captured status of the MMDVM instead of simulating the other modes
+	void add(const CCaptureRecord& record)
+	{
+		m_replay = true;
+		m_status.push_back(record);
+	}
+
+	void start(unsigned long long base)
+	{
+		m_base = base;
+	}
+
+protected:
+	virtual bool connect()
+	{
+		return true;
+	}
+
+	virtual int receive(unsigned char* data, unsigned int)
+	{
+		unsigned long long time = now();
+
+		if (m_replay)
+			return replay(data, time);
+
+		// Spells in other modes
+		if (m_busy > 0U && time >= m_change) {
+			m_free = !m_free;
+			m_change = time + nextChange(m_free);
+			if (!m_free)
+				m_busyStart = time;
+			else
+				m_results.m_busy += time - m_busyStart;
+		}
+
+		if (m_reported && m_free == m_lastFree)
+			return 0;
+
+		m_reported = true;
+		m_lastFree = m_free;
+		data[0U] = m_free ? 0x00U : 0xFFU;
+
+		return 1;
+	}
+
+	virtual bool send(const unsigned char* data, unsigned int length)
+	{
+		if (length < 10U || ::memcmp(data, "POCSAG", 6U) != 0)
+			return false;
+
+		unsigned int ric        = (data[6U] << 16) | (data[7U] << 8) | data[8U];
+		unsigned int functional = data[9U];
+		std::string text((const char*)data + 10U, length - 10U);
+
+		double time = double(now());
+
+		unsigned int codewords = 0U;
+		if (time >= m_txEnd) {
+			m_txEnd = time;
+			codewords += PREAMBLE_CODEWORDS;
+		}
+
+		unsigned int bits = 0U;
+		if (functional == 0U)
+			bits = (unsigned int)text.size() * 4U;
+		else if (functional == 2U || functional == 3U)
+			bits = (unsigned int)text.size() * 7U;
+
+		unsigned int words = 2U * (ric & 0x07U) + 1U + (bits + 19U) / 20U;
+		codewords += ((words + 15U) / 16U) * BATCH_CODEWORDS;
+
+		double start = m_txEnd;
+		m_txEnd += double(codewords) * CODEWORD_TIME_MS;
+
+		account(start, m_txEnd);
+
+		if (m_txEnd > double(m_end))
+			m_results.m_backlog = m_txEnd - double(m_end);
+
+		m_results.m_sent++;
+		m_results.m_codewords += codewords;
+		if (m_txEnd <= double(m_end))
+			m_results.m_transmitted++;
+
+		char key[20U];
+		::snprintf(key, 20U, "%u:", ric);
+
+		std::map<std::string, std::deque<unsigned long long>>::iterator it = m_results.m_waiting.find(std::string(key) + text);
+		if (it != m_results.m_waiting.end() && !it->second.empty()) {
+			m_results.m_latency.add((unsigned int)(m_txEnd - double(it->second.front())));
+			it->second.pop_front();
+		}
+
+		return true;
+	}
+
+	virtual void disconnect()
+	{
+	}
+
+private:
+	CSimResults&       m_results;
+	const bool*        m_slots;
+	unsigned long long m_end;
+	unsigned int       m_busy;
+	std::mt19937       m_random;
+	double             m_txEnd;
+	bool               m_reported;
+	bool               m_free;
+	bool               m_lastFree;
+	unsigned long long m_change;
+	unsigned long long m_busyStart;
+	bool               m_replay;
+	std::deque<CCaptureRecord> m_status;
+	unsigned long long m_base;
+
+	int replay(unsigned char* data, unsigned long long time)
+	{
+		if (m_status.empty() || (m_base + m_status.front().m_time) > monotonic())
+			return 0;
+
+		CCaptureRecord record = m_status.front();
+		m_status.pop_front();
+
+		if (record.m_data.empty())
+			return 0;
+
+		data[0U] = record.m_data[0U];
+
+		if (data[0U] == 0xFFU && m_free) {
+			m_free = false;
+			m_busyStart = time;
+		} else if (data[0U] == 0x00U && !m_free) {
+			m_free = true;
+			m_results.m_busy += time - m_busyStart;
+		}
+
+		return 1;
+	}
+
+	unsigned long long nextChange(bool free)
+	{
+		if (m_busy == 0U)
+			return 0ULL;
+
+		// Exponential spells, with the free ones scaled to give the busy fraction
+		double mean = double(BUSY_MEAN_MS);
+		if (free)
+			mean = mean * double(100U - m_busy) / double(m_busy);
+
+		std::exponential_distribution<double> spell(1.0 / mean);
+		return (unsigned long long)spell(m_random) + 1ULL;
+	}
+
+	// Split the transmission between the slots that are scheduled and those that aren't, up to the end of the run
+	void account(double start, double end)
+	{
+		if (end > double(m_end))
+			end = double(m_end);
+
+		while (start < end) {
+			double boundary = (std::floor(start / double(SLOT_MS)) + 1.0) * double(SLOT_MS);
+			double part     = (end < boundary ? end : boundary) - start;
+
+			unsigned int slot = (unsigned int)((unsigned long long)(start / double(SLOT_MS)) % 16ULL);
+			if (m_slots[slot])
+				m_results.m_inSchedule += part;
+			else
+				m_results.m_outSchedule += part;
+
+			start += part;
+		}
+	}
+};
+
+static bool readTrace(const char* file, CSimDAPNETNetwork& network, unsigned int& count)
+{
+	FILE* fp = ::fopen(file, "rt");
+	if (fp == nullptr) {
+		::fprintf(stderr, "dapnetsim: cannot open %s\n", file);
+		return false;
+	}
+
+	// Lines of seconds from the start and a page in the DAPNET form, type:speed:ric:functional:text
+	char buffer[500U];
+	while (::fgets(buffer, 500U, fp) != nullptr) {
+		if (buffer[0U] == '#' || buffer[0U] == '\n' || buffer[0U] == '\r')
+			continue;
+
+		char* p = ::strpbrk(buffer, "\r\n");
+		if (p != nullptr)
+			*p = '\0';
+
+		char* page = nullptr;
+		double secs = ::strtod(buffer, &page);
+		while (*page == ' ' || *page == '\t')
+			page++;
+
+		CSimArrival arrival;
+		arrival.m_time = START_TIME_MS + (unsigned long long)(secs * 1000.0);
+		arrival.m_line = page;
+		network.add(arrival);
+
+		count++;
+	}
+
+	::fclose(fp);
+
+	return true;
+}
+
+static bool readCapture(const char* file, std::deque<CCaptureRecord>& records, unsigned long long& start)
+{
+	CCaptureReader reader(file);
+	if (!reader.open()) {
+		::fprintf(stderr, "dapnetsim: cannot open the capture %s\n", file);
+		return false;
+	}
+
+	start = reader.getStart();
+
+	CCaptureRecord record;
+	while (reader.read(record))
+		records.push_back(record);
+
+	reader.close();
+
+	return true;
+}
+
+// The last schedule sent by the core, as the slots to measure the airtime against
+static void captureSlots(const std::deque<CCaptureRecord>& records, std::string& slots)
+{
+	for (std::deque<CCaptureRecord>::const_iterator it = records.begin(); it != records.end(); ++it) {
+		if (it->m_type != CAPTURE_TYPE::DAPNET_RX || it->m_data.size() < 2U || it->m_data[0U] != '4' || it->m_data[1U] != ':')
+			continue;
+
+		slots.clear();
+		for (std::vector<unsigned char>::const_iterator c = it->m_data.begin() + 2U; c != it->m_data.end() && *c != '\r' && *c != '\n'; ++c)
+			slots += char(*c);
+	}
+}
+
+static void generate(CSimDAPNETNetwork& network, unsigned int hours, unsigned int rate, unsigned int alpha, unsigned int length, unsigned int seed, unsigned int& count)
+{
+	std::mt19937 random(seed);
+	std::exponential_distribution<double> gap(double(rate) / 3600000.0);
+	std::uniform_int_distribution<unsigned int> percent(0U, 99U);
+	std::uniform_int_distribution<unsigned int> ric(1U, 0x1FFFFFU);
+
+	unsigned long long end = START_TIME_MS + hours * 3600000ULL;
+
+	double time = double(START_TIME_MS);
+	for (;;) {
+		time += gap(random);
+		if (time >= double(end))
+			break;
+
+		// A unique text, so that the page can be found when it is sent
+		char text[200U];
+		char line[300U];
+		if (percent(random) < alpha) {
+			::snprintf(text, 200U, "SIM %06u ", count);
+			std::string body(text);
+			while (body.size() < length)
+				body += char('a' + (body.size() % 26U));
+			::snprintf(line, 300U, "6:1:%X:3:%s", ric(random), body.c_str());
+		} else {
+			::snprintf(line, 300U, "6:1:%X:0:%06u", ric(random), count);
+		}
+
+		CSimArrival arrival;
+		arrival.m_time = (unsigned long long)time;
+		arrival.m_line = line;
+		network.add(arrival);
+
+		count++;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const char* iniFile = DEFAULT_INI_FILE;
+	const char* trace   = nullptr;
+	const char* capture = nullptr;
+	unsigned int hours  = 1U;
+	unsigned int rate   = 600U;
+	unsigned int alpha  = 80U;
+	unsigned int length = 40U;
+	unsigned int busy   = 0U;
+	unsigned int seed   = 1U;
+	bool realTime       = false;
+	bool verbose        = false;
+	std::string slots   = "0123456789ABCDEF";
+
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "-H" && (i + 1) < argc) {
+			hours = (unsigned int)::atoi(argv[++i]);
+		} else if (arg == "-r" && (i + 1) < argc) {
+			rate = (unsigned int)::atoi(argv[++i]);
+		} else if (arg == "-a" && (i + 1) < argc) {
+			alpha = (unsigned int)::atoi(argv[++i]);
+		} else if (arg == "-l" && (i + 1) < argc) {
+			length = (unsigned int)::atoi(argv[++i]);
+		} else if (arg == "-s" && (i + 1) < argc) {
+			slots = argv[++i];
+		} else if (arg == "-b" && (i + 1) < argc) {
+			busy = (unsigned int)::atoi(argv[++i]);
+		} else if (arg == "-S" && (i + 1) < argc) {
+			seed = (unsigned int)::atoi(argv[++i]);
+		} else if (arg == "-t" && (i + 1) < argc) {
+			trace = argv[++i];
+		} else if (arg == "-R" && (i + 1) < argc) {
+			capture = argv[++i];
+		} else if (arg == "-x") {
+			realTime = true;
+		} else if (arg == "-v") {
+			verbose = true;
+		} else if (arg.substr(0, 1) == "-") {
+			::fprintf(stderr, "%s", USAGE);
+			return 1;
+		} else {
+			iniFile = argv[i];
+		}
+	}
+
+	// The traffic and the MMDVM status of a capture replace the simulated ones
+	std::deque<CCaptureRecord> records;
+	unsigned long long start = START_TIME_MS;
+	if (capture != nullptr) {
+		if (!readCapture(capture, records, start))
+			return 1;
+
+		start /= 1000000ULL;
+
+		captureSlots(records, slots);
+	}
+
+	bool schedule[16U];
+	if (hours == 0U || alpha > 100U || length > 80U || busy >= 100U || !parseSlots(slots, schedule) || (realTime && capture == nullptr) || (busy > 0U && capture != nullptr)) {
+		::fprintf(stderr, "%s", USAGE);
+		return 1;
+	}
+
+	// The virtual clock starts when the capture did so that the slots fall at the same times, in real time they can't
+	CVirtualClock clock(start * 1000000ULL);
+	if (realTime)
+		start = now();
+	else
+		CClock::set(&clock);
+
+	::LogInitialise(verbose ? 2U : 4U, 0U);
+
+	CSimResults results;
+
+	unsigned long long duration = hours * 3600000ULL;
+	if (capture != nullptr)
+		duration = (records.empty() ? 0ULL : records.back().m_time / 1000ULL) + REPLAY_TAIL_MS;
+
+	unsigned long long end = start + duration;
+
+	CSimDAPNETNetwork* dapnet    = nullptr;
+	CReplayDAPNETNetwork* replay = nullptr;
+	CSimMMDVM* mmdvm = new CSimMMDVM(results, schedule, busy, seed, end);
+
+	unsigned int offered = 0U;
+	if (capture != nullptr) {
+		replay = new CReplayDAPNETNetwork(results, end);
+
+		for (std::deque<CCaptureRecord>::const_iterator it = records.begin(); it != records.end(); ++it) {
+			if (it->m_type == CAPTURE_TYPE::MMDVM_RX) {
+				mmdvm->add(*it);
+			} else {
+				replay->add(*it);
+				if (it->m_type == CAPTURE_TYPE::DAPNET_RX && !it->m_data.empty() && it->m_data[0U] == '#')
+					offered++;
+			}
+		}
+	} else {
+		dapnet = new CSimDAPNETNetwork(results, slots, end);
+
+		if (trace != nullptr) {
+			if (!readTrace(trace, *dapnet, offered)) {
+				delete dapnet;
+				delete mmdvm;
+				return 1;
+			}
+		} else {
+			generate(*dapnet, hours, rate, alpha, length, seed, offered);
+		}
+	}
+
+	std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+
+	CDAPNETGateway* gateway = new CDAPNETGateway(std::string(iniFile));
+
+	if (replay != nullptr) {
+		unsigned long long base = monotonic();
+		replay->start(base);
+		mmdvm->start(base);
+
+		gateway->setNetworks(replay, mmdvm);
+		replay->setGateway(gateway);
+	} else {
+		gateway->setNetworks(dapnet, mmdvm);
+		dapnet->setGateway(gateway);
+	}
+
+	unsigned int lost = 0U;
+
+	int ret = gateway->run();
+	if (replay != nullptr)
+		lost = replay->getLost();
+
+	delete gateway;
+
+	double real = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+	::LogFinalise();
+
+	if (ret != 0) {
+		::fprintf(stderr, "dapnetsim: the gateway failed to start\n");
+		return ret;
+	}
+
+	unsigned int scheduled = 0U;
+	for (unsigned long long t = (start / SLOT_MS) * SLOT_MS; t < end; t += SLOT_MS) {
+		if (schedule[(t / SLOT_MS) % 16ULL])
+			scheduled++;
+	}
+
+	double span     = double(end - start);
+	double capacity = double(scheduled) * double(SLOT_MS);
+	double airtime  = results.m_inSchedule + results.m_outSchedule;
+
+	if (capture != nullptr)
+		::printf("Replayed %.1f min of %s in %.2f s, slots %s, %u reconnects\n", span / 60000.0, capture, real, slots.c_str(), lost);
+	else
+		::printf("Simulated %u h in %.2f s, slots %s\n", hours, real, slots.c_str());
+	::printf("Pages offered   %u, arrived %u, sent to the MMDVM %u, not sent %u\n", offered, results.m_arrived, results.m_sent, results.m_arrived - results.m_sent);
+	::printf("Pages/hour      %.1f transmitted\n", double(results.m_transmitted) * 3600000.0 / span);
+	if (results.m_latency.getCount() > 0U)
+		::printf("Latency ms      p50 %u p90 %u p99 %u max %u\n", results.m_latency.getPercentile(50U), results.m_latency.getPercentile(90U), results.m_latency.getPercentile(99U), results.m_latency.getPercentile(100U));
+	::printf("Slot use        %.1f%% of the scheduled airtime\n", capacity > 0.0 ? results.m_inSchedule * 100.0 / capacity : 0.0);
+	::printf("Out of slot     %.1f%% of the transmission, %.0f ms\n", airtime > 0.0 ? results.m_outSchedule * 100.0 / airtime : 0.0, results.m_outSchedule);
+	::printf("Codewords       %llu\n", results.m_codewords);
+	if (results.m_backlog > 0.0)
+		::printf("MMDVM backlog   %.1f s still to send at the end\n", results.m_backlog / 1000.0);
+	if (busy > 0U || results.m_busy > 0ULL)
+		::printf("MMDVM busy      %.1f%%\n", double(results.m_busy) * 100.0 / span);
+
+	return 0;
+}
@@ -0,0 +1,169 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+// Shows the statistics page of a running DAPNET Gateway in the style of vmstat
+
+#include "StatsPage.h"
+
+#include <string>
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+static const char* USAGE = "Usage: dapnetstat [-n name] [interval [count]]\n";
+
+static const unsigned int HEADER_LINES = 20U;
+
+static double rate(uint64_t now, uint64_t last, double secs)
+{
+	return secs > 0.0 ? double(now - last) / secs : 0.0;
+}
+
+static void header()
+{
+	::printf("    time slot free queue  recv/s  sent/s  filt/s   rej/s defer recon airtime loop_ms max_ms  mqtt\n");
+}
+
+static void line(const CStatsPageData& now, const CStatsPageData& last)
+{
+	double secs = double(now.m_time - last.m_time) / 1000.0;
+
+	time_t t = time_t(now.m_time / 1000ULL);
+	struct tm tm;
+	::localtime_r(&t, &tm);
+
+	uint64_t budget = now.m_codewordsBudget - last.m_codewordsBudget;
+	double airtime  = budget > 0U ? double(now.m_codewordsSent - last.m_codewordsSent) * 100.0 / double(budget) : 0.0;
+
+	uint64_t loops = now.m_loops - last.m_loops;
+	double loopTime = loops > 0U ? double(now.m_loopTimeTotal - last.m_loopTimeTotal) / double(loops) : 0.0;
+
+	::printf("%02d:%02d:%02d %4u %4s %5u %7.1f %7.1f %7.1f %7.1f %5llu %5llu %6.1f%% %7.2f %6u %5u\n",
+		tm.tm_hour, tm.tm_min, tm.tm_sec,
+		now.m_currentSlot, now.m_mmdvmFree == 1U ? "yes" : "no", now.m_queueDepth,
+		rate(now.m_received, last.m_received, secs), rate(now.m_sent, last.m_sent, secs),
+		rate(now.m_filtered, last.m_filtered, secs), rate(now.m_rejected, last.m_rejected, secs),
+		(unsigned long long)(now.m_deferred - last.m_deferred), (unsigned long long)now.m_reconnects,
+		airtime, loopTime, now.m_loopTimeMax, now.m_mqttBuffered);
+
+	::fflush(stdout);
+}
+
+int main(int argc, char** argv)
+{
+	std::string name = "/dapnetgateway";
+	unsigned int interval = 1U;
+	int count = -1;
+
+	int n = 0;
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "-n" && (i + 1) < argc) {
+			name = argv[++i];
+		} else if (arg.substr(0, 1) == "-") {
+			::fprintf(stderr, "%s", USAGE);
+			return 1;
+		} else if (n == 0) {
+			interval = (unsigned int)::atoi(argv[i]);
+			n++;
+		} else if (n == 1) {
+			count = ::atoi(argv[i]);
+			n++;
+		} else {
+			::fprintf(stderr, "%s", USAGE);
+			return 1;
+		}
+	}
+
+	if (interval == 0U) {
+		::fprintf(stderr, "%s", USAGE);
+		return 1;
+	}
+
+	int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+	if (fd == -1) {
+		::fprintf(stderr, "dapnetstat: cannot open %s, is the gateway running with [StatsPage] enabled?\n", name.c_str());
+		return 1;
+	}
+
+	struct stat st;
+	if (::fstat(fd, &st) == -1 || size_t(st.st_size) < sizeof(CStatsPageData)) {
+		::fprintf(stderr, "dapnetstat: %s is not a statistics page\n", name.c_str());
+		::close(fd);
+		return 1;
+	}
+
+	void* addr = ::mmap(nullptr, sizeof(CStatsPageData), PROT_READ, MAP_SHARED, fd, 0);
+	::close(fd);
+
+	if (addr == MAP_FAILED) {
+		::fprintf(stderr, "dapnetstat: cannot map %s\n", name.c_str());
+		return 1;
+	}
+
+	const CStatsPageData* page = (const CStatsPageData*)addr;
+
+	CStatsPageData last;
+	if (!StatsPageRead(page, last)) {
+		::fprintf(stderr, "dapnetstat: %s is not a version %u statistics page\n", name.c_str(), STATS_PAGE_VERSION);
+		return 1;
+	}
+
+	// Like vmstat the first line is the averages since the gateway started
+	CStatsPageData start;
+	::memset((void*)&start, 0x00U, sizeof(CStatsPageData));
+	start.m_time = last.m_start;
+
+	header();
+	line(last, start);
+
+	unsigned int lines = 1U;
+	for (int i = 1; count < 0 || i < count; i++) {
+		::sleep(interval);
+
+		CStatsPageData now;
+		if (!StatsPageRead(page, now)) {
+			::fprintf(stderr, "dapnetstat: cannot read %s\n", name.c_str());
+			return 1;
+		}
+
+		// The gateway is blocked, or it has stopped, a restarted gateway creates a new page
+		if (now.m_time == last.m_time) {
+			::fprintf(stderr, "dapnetstat: no update for %u seconds\n", (unsigned int)((::time(nullptr) * 1000ULL - now.m_time) / 1000ULL));
+			continue;
+		}
+
+		if ((lines % HEADER_LINES) == 0U)
+			header();
+
+		line(now, last);
+		lines++;
+
+		::memcpy((void*)&last, (const void*)&now, sizeof(CStatsPageData));
+	}
+
+	::munmap(addr, sizeof(CStatsPageData));
+
+	return 0;
+}
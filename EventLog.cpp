@@ -0,0 +1,304 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "EventLog.h"
+#include "Log.h"
+
+#include <cstdio>
+#include <cassert>
+#include <cstring>
+#include <ctime>
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+const unsigned int MAX_CONTINUATIONS = 255U;
+
+static CEventLog* m_eventLog = nullptr;
+
+CEventLog::CEventLog(const std::string& fileName, unsigned int size, unsigned int files, bool frames) :
+m_fileName(fileName),
+m_capacity(0U),
+m_files(files),
+m_frames(frames),
+m_fd(-1),
+m_map(nullptr),
+m_count(0U),
+m_mutex()
+{
+	assert(!fileName.empty());
+	assert(size > 0U);
+
+	// The size is in kilobytes, the first record is the header
+	m_capacity = (size * 1024U) / EVENT_RECORD_LENGTH - 1U;
+}
+
+CEventLog::~CEventLog()
+{
+}
+
+bool CEventLog::open()
+{
+#if defined(_WIN32) || defined(_WIN64)
+	LogWarning("The event log is not supported on Windows");
+	return false;
+#else
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	// Keep any previous log as the first of the old files
+	struct stat st;
+	if (::stat(m_fileName.c_str(), &st) == 0)
+		rotate();
+	else
+		create();
+
+	if (m_map == nullptr)
+		return false;
+
+	LogMessage("Opened the event log %s with room for %u records", m_fileName.c_str(), m_capacity);
+
+	return true;
+#endif
+}
+
+void CEventLog::writeMessage(EVENT_TYPE type, const CPOCSAGMessage* message, EVENT_REASON reason, unsigned char slot)
+{
+	assert(message != nullptr);
+
+	CEventRecord record;
+	::memset(&record, 0x00U, sizeof(CEventRecord));
+
+	record.m_type       = (unsigned char)type;
+	record.m_msgType    = message->m_type;
+	record.m_functional = message->m_functional;
+	record.m_reason     = (unsigned char)reason;
+	record.m_slot       = slot;
+	record.m_id         = message->m_id;
+	record.m_ric        = message->m_ric;
+
+	write(record, message->m_message, message->m_length);
+}
+
+void CEventLog::writeFrame(EVENT_TYPE type, const unsigned char* data, unsigned int length)
+{
+	assert(data != nullptr);
+
+	if (!m_frames)
+		return;
+
+	CEventRecord record;
+	::memset(&record, 0x00U, sizeof(CEventRecord));
+
+	record.m_type = (unsigned char)type;
+
+	write(record, data, length);
+}
+
+void CEventLog::close()
+{
+#if !defined(_WIN32) && !defined(_WIN64)
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (m_map != nullptr) {
+		::munmap(m_map, (m_capacity + 1U) * EVENT_RECORD_LENGTH);
+		m_map = nullptr;
+	}
+
+	if (m_fd != -1) {
+		::close(m_fd);
+		m_fd = -1;
+	}
+#endif
+}
+
+bool CEventLog::create()
+{
+#if defined(_WIN32) || defined(_WIN64)
+	return false;
+#else
+	unsigned int length = (m_capacity + 1U) * EVENT_RECORD_LENGTH;
+
+	m_fd = ::open(m_fileName.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (m_fd == -1) {
+		LogError("Cannot create the event log %s, err=%d", m_fileName.c_str(), errno);
+		return false;
+	}
+
+	if (::ftruncate(m_fd, length) == -1) {
+		LogError("Cannot set the size of the event log %s, err=%d", m_fileName.c_str(), errno);
+		::close(m_fd);
+		m_fd = -1;
+		return false;
+	}
+
+	void* map = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+	if (map == MAP_FAILED) {
+		LogError("Cannot map the event log %s, err=%d", m_fileName.c_str(), errno);
+		::close(m_fd);
+		m_fd = -1;
+		return false;
+	}
+
+	m_map   = (unsigned char*)map;
+	m_count = 0U;
+
+	struct timespec now;
+	::clock_gettime(CLOCK_REALTIME, &now);
+
+	CEventHeader* header = (CEventHeader*)m_map;
+	::memcpy(header->m_magic, EVENT_MAGIC, 8U);
+	header->m_version      = EVENT_VERSION;
+	header->m_recordLength = EVENT_RECORD_LENGTH;
+	header->m_capacity     = m_capacity;
+	header->m_count        = 0U;
+	header->m_created      = now.tv_sec * 1000000ULL + now.tv_nsec / 1000ULL;
+
+	return true;
+#endif
+}
+
+void CEventLog::rotate()
+{
+#if !defined(_WIN32) && !defined(_WIN64)
+	if (m_map != nullptr) {
+		::munmap(m_map, (m_capacity + 1U) * EVENT_RECORD_LENGTH);
+		m_map = nullptr;
+	}
+
+	if (m_fd != -1) {
+		::close(m_fd);
+		m_fd = -1;
+	}
+
+	for (unsigned int i = m_files; i > 1U; i--) {
+		std::string from = m_fileName + "." + std::to_string(i - 1U);
+		std::string to   = m_fileName + "." + std::to_string(i);
+		::rename(from.c_str(), to.c_str());
+	}
+
+	if (m_files > 0U) {
+		std::string to = m_fileName + ".1";
+		::rename(m_fileName.c_str(), to.c_str());
+	}
+
+	create();
+#endif
+}
+
+void CEventLog::write(CEventRecord& record, const unsigned char* data, unsigned int length)
+{
+	assert(data != nullptr);
+
+	// The whole event must fit into an empty file
+	unsigned int continuations = MAX_CONTINUATIONS;
+	if (continuations > (m_capacity - 1U))
+		continuations = m_capacity - 1U;
+
+	if (length > (EVENT_DATA_LENGTH + continuations * EVENT_EXTRA_LENGTH)) {
+		LogWarningLimited("An event of %u bytes has been truncated to fit the event log", length);
+		length = EVENT_DATA_LENGTH + continuations * EVENT_EXTRA_LENGTH;
+	}
+
+	unsigned int first = length > EVENT_DATA_LENGTH ? EVENT_DATA_LENGTH : length;
+	unsigned int count = (length - first + EVENT_EXTRA_LENGTH - 1U) / EVENT_EXTRA_LENGTH;
+
+	record.m_length = length;
+	record.m_count  = count;
+	::memcpy(record.m_data, data, first);
+
+#if !defined(_WIN32) && !defined(_WIN64)
+	struct timespec now;
+	::clock_gettime(CLOCK_REALTIME, &now);
+	record.m_time = now.tv_sec * 1000000ULL + now.tv_nsec / 1000ULL;
+#endif
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if ((m_count + count + 1U) > m_capacity)
+		rotate();
+
+	if (m_map == nullptr)
+		return;
+
+	unsigned char* p = m_map + (m_count + 1U) * EVENT_RECORD_LENGTH;
+	::memcpy(p, &record, EVENT_RECORD_LENGTH);
+
+	unsigned int offset = first;
+	for (unsigned int i = 0U; i < count; i++) {
+		p += EVENT_RECORD_LENGTH;
+
+		unsigned int n = length - offset;
+		if (n > EVENT_EXTRA_LENGTH)
+			n = EVENT_EXTRA_LENGTH;
+
+		p[0U] = (unsigned char)EVENT_TYPE::CONTINUATION;
+		::memcpy(p + 1U, data + offset, n);
+		::memset(p + 1U + n, 0x00U, EVENT_EXTRA_LENGTH - n);
+
+		offset += n;
+	}
+
+	m_count += count + 1U;
+
+	// Only make the new records visible once they're complete
+	CEventHeader* header = (CEventHeader*)m_map;
+	header->m_count = m_count;
+}
+
+bool EventInitialise(const std::string& fileName, unsigned int size, unsigned int files, bool frames)
+{
+	EventFinalise();
+
+	CEventLog* eventLog = new CEventLog(fileName, size, files, frames);
+
+	bool ret = eventLog->open();
+	if (!ret) {
+		delete eventLog;
+		return false;
+	}
+
+	m_eventLog = eventLog;
+
+	return true;
+}
+
+void EventFinalise()
+{
+	if (m_eventLog != nullptr) {
+		m_eventLog->close();
+		delete m_eventLog;
+		m_eventLog = nullptr;
+	}
+}
+
+void EventMessage(EVENT_TYPE type, const CPOCSAGMessage* message, EVENT_REASON reason, unsigned char slot)
+{
+	if (m_eventLog != nullptr)
+		m_eventLog->writeMessage(type, message, reason, slot);
+}
+
+void EventFrame(EVENT_TYPE type, const unsigned char* data, unsigned int length)
+{
+	if (m_eventLog != nullptr)
+		m_eventLog->writeFrame(type, data, length);
+}
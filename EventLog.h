@@ -0,0 +1,135 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(EVENTLOG_H)
+#define	EVENTLOG_H
+
+#include "POCSAGMessage.h"
+
+#include <string>
+#include <mutex>
+
+const char EVENT_MAGIC[] = "DAPNETEV";
+
+const unsigned int EVENT_VERSION       = 1U;
+const unsigned int EVENT_RECORD_LENGTH = 64U;
+const unsigned int EVENT_DATA_LENGTH   = 40U;
+const unsigned int EVENT_EXTRA_LENGTH  = EVENT_RECORD_LENGTH - 1U;
+
+enum class EVENT_TYPE : unsigned char {
+	CONTINUATION,
+	MESSAGE_RECEIVED,
+	MESSAGE_FILTERED,
+	MESSAGE_QUEUED,
+	MESSAGE_SENT,
+	MESSAGE_REJECTED,
+	DAPNET_RX,
+	DAPNET_TX,
+	POCSAG_RX,
+	POCSAG_TX
+};
+
+enum class EVENT_REASON : unsigned char {
+	NONE,
+	WHITELIST,
+	BLACKLIST,
+	BLACKLIST_REGEX,
+	WHITELIST_REGEX,
+	STALE_TIME
+};
+
+inline const char* EventTypeName(EVENT_TYPE type)
+{
+	static const char* NAMES[] = { "continuation", "received", "filtered", "queued", "sent", "rejected", "dapnet_rx", "dapnet_tx", "pocsag_rx", "pocsag_tx" };
+
+	return type <= EVENT_TYPE::POCSAG_TX ? NAMES[(unsigned int)type] : "unknown";
+}
+
+inline const char* EventReasonName(EVENT_REASON reason)
+{
+	static const char* NAMES[] = { "none", "whitelist", "blacklist", "blacklist_regex", "whitelist_regex", "stale_time" };
+
+	return reason <= EVENT_REASON::STALE_TIME ? NAMES[(unsigned int)reason] : "unknown";
+}
+
+// The first record of a file, all of the values are little endian
+struct CEventHeader {
+	char               m_magic[8U];
+	unsigned int       m_version;
+	unsigned int       m_recordLength;
+	unsigned int       m_capacity;
+	unsigned int       m_count;
+	unsigned long long m_created;
+	unsigned char      m_spare[32U];
+};
+
+// A message or frame event, any data that doesn't fit into m_data follows
+// in EVENT_CONTINUATION records, each of which holds EVENT_EXTRA_LENGTH bytes
+// after its type byte.
+struct CEventRecord {
+	unsigned char      m_type;
+	unsigned char      m_msgType;
+	unsigned char      m_functional;
+	unsigned char      m_reason;
+	unsigned short     m_length;
+	unsigned char      m_slot;
+	unsigned char      m_count;
+	unsigned long long m_time;
+	unsigned int       m_id;
+	unsigned int       m_ric;
+	unsigned char      m_data[EVENT_DATA_LENGTH];
+};
+
+static_assert(sizeof(CEventHeader) == EVENT_RECORD_LENGTH, "The event header must be one record long");
+static_assert(sizeof(CEventRecord) == EVENT_RECORD_LENGTH, "The event record must be one record long");
+
+// Appends fixed size records to a memory mapped file, rotating it when full
+class CEventLog {
+public:
+	CEventLog(const std::string& fileName, unsigned int size, unsigned int files, bool frames);
+	~CEventLog();
+
+	bool open();
+
+	void writeMessage(EVENT_TYPE type, const CPOCSAGMessage* message, EVENT_REASON reason, unsigned char slot);
+	void writeFrame(EVENT_TYPE type, const unsigned char* data, unsigned int length);
+
+	void close();
+
+private:
+	std::string    m_fileName;
+	unsigned int   m_capacity;
+	unsigned int   m_files;
+	bool           m_frames;
+	int            m_fd;
+	unsigned char* m_map;
+	unsigned int   m_count;
+	std::mutex     m_mutex;
+
+	bool create();
+	void rotate();
+	void write(CEventRecord& record, const unsigned char* data, unsigned int length);
+};
+
+extern bool EventInitialise(const std::string& fileName, unsigned int size, unsigned int files, bool frames);
+extern void EventFinalise();
+
+extern void EventMessage(EVENT_TYPE type, const CPOCSAGMessage* message, EVENT_REASON reason = EVENT_REASON::NONE, unsigned char slot = 0U);
+extern void EventFrame(EVENT_TYPE type, const unsigned char* data, unsigned int length);
+
+#endif
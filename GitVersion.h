@@ -0,0 +1 @@
+const char *gitversion = "0bbf8d15f2aef0d4a801efbea26f97225160fbd4";
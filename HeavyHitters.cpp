@@ -0,0 +1,88 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "HeavyHitters.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <cassert>
+
+CHeavyHitters::CHeavyHitters() :
+m_counters(),
+m_used(0U)
+{
+}
+
+CHeavyHitters::~CHeavyHitters()
+{
+}
+
+void CHeavyHitters::add(unsigned int key, unsigned int weight)
+{
+	unsigned int min = 0U;
+
+	for (unsigned int i = 0U; i < m_used; i++) {
+		if (m_counters[i].m_key == key) {
+			m_counters[i].m_count += weight;
+			return;
+		}
+
+		if (m_counters[i].m_count < m_counters[min].m_count)
+			min = i;
+	}
+
+	if (m_used < HEAVY_HITTERS_CAPACITY) {
+		m_counters[m_used].m_key   = key;
+		m_counters[m_used].m_count = weight;
+		m_counters[m_used].m_error = 0ULL;
+		m_used++;
+		return;
+	}
+
+	// Take over the smallest counter, which may have been this key's all along
+	m_counters[min].m_key    = key;
+	m_counters[min].m_error  = m_counters[min].m_count;
+	m_counters[min].m_count += weight;
+}
+
+void CHeavyHitters::write(nlohmann::json& json, const char* name, unsigned int count) const
+{
+	assert(name != nullptr);
+
+	std::vector<CCounter> counters(m_counters, m_counters + m_used);
+
+	std::sort(counters.begin(), counters.end(), [](const CCounter& a, const CCounter& b) { return a.m_count > b.m_count; });
+
+	if (counters.size() > count)
+		counters.resize(count);
+
+	json = nlohmann::json::array();
+	for (std::vector<CCounter>::const_iterator it = counters.cbegin(); it != counters.cend(); ++it) {
+		nlohmann::json entry;
+		entry[name]    = it->m_key;
+		entry["count"] = it->m_count;
+		entry["error"] = it->m_error;
+		json.push_back(entry);
+	}
+}
+
+void CHeavyHitters::reset()
+{
+	m_used = 0U;
+}
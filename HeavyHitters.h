@@ -0,0 +1,53 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(HEAVYHITTERS_H)
+#define	HEAVYHITTERS_H
+
+#include <nlohmann/json.hpp>
+
+const unsigned int HEAVY_HITTERS_CAPACITY = 64U;
+
+// The Space-Saving algorithm, weighted. It tracks the largest keys in a fixed
+// number of counters however many distinct keys are seen. Any key whose true
+// total is more than total / capacity is guaranteed to be present, and each
+// count is over-estimated by at most its error.
+class CHeavyHitters {
+public:
+	CHeavyHitters();
+	~CHeavyHitters();
+
+	void add(unsigned int key, unsigned int weight);
+
+	// The largest count entries as objects with the key, count and error
+	void write(nlohmann::json& json, const char* name, unsigned int count) const;
+
+	void reset();
+
+private:
+	struct CCounter {
+		unsigned int       m_key;
+		unsigned long long m_count;
+		unsigned long long m_error;
+	};
+
+	CCounter     m_counters[HEAVY_HITTERS_CAPACITY];
+	unsigned int m_used;
+};
+
+#endif
@@ -0,0 +1,112 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "Histogram.h"
+
+#include <cassert>
+#include <cstring>
+
+CHistogram::CHistogram() :
+m_buckets(),
+m_count(0U),
+m_total(0ULL),
+m_min(0xFFFFFFFFU),
+m_max(0U)
+{
+	reset();
+}
+
+CHistogram::~CHistogram()
+{
+}
+
+unsigned int CHistogram::getCount() const
+{
+	return m_count;
+}
+
+unsigned int CHistogram::getPercentile(unsigned int percent) const
+{
+	assert(percent <= 100U);
+
+	if (m_count == 0U)
+		return 0U;
+
+	// The rank of the value wanted, rounded up
+	unsigned long long rank = ((unsigned long long)m_count * percent + 99ULL) / 100ULL;
+	if (rank == 0ULL)
+		rank = 1ULL;
+
+	unsigned long long count = 0ULL;
+	for (unsigned int i = 0U; i < HISTOGRAM_BUCKETS; i++) {
+		count += m_buckets[i];
+		if (count >= rank) {
+			// Report the top of the bucket, but never more than was seen
+			unsigned int top = (i + 1U) < HISTOGRAM_BUCKETS ? value(i + 1U) - 1U : 0xFFFFFFFFU;
+			return top < m_max ? top : m_max;
+		}
+	}
+
+	return m_max;
+}
+
+void CHistogram::write(nlohmann::json& json) const
+{
+	json["count"] = m_count;
+	if (m_count == 0U)
+		return;
+
+	json["min"]  = m_min;
+	json["mean"] = (unsigned int)(m_total / m_count);
+	json["p50"]  = getPercentile(50U);
+	json["p90"]  = getPercentile(90U);
+	json["p99"]  = getPercentile(99U);
+	json["max"]  = m_max;
+
+	// Pairs of the bottom of each bucket and its count, so that histograms can be merged
+	nlohmann::json buckets = nlohmann::json::array();
+	for (unsigned int i = 0U; i < HISTOGRAM_BUCKETS; i++) {
+		if (m_buckets[i] > 0U)
+			buckets.push_back({ value(i), m_buckets[i] });
+	}
+
+	json["buckets"] = buckets;
+}
+
+void CHistogram::reset()
+{
+	::memset(m_buckets, 0x00U, sizeof(m_buckets));
+
+	m_count = 0U;
+	m_total = 0ULL;
+	m_min   = 0xFFFFFFFFU;
+	m_max   = 0U;
+}
+
+unsigned int CHistogram::value(unsigned int index)
+{
+	assert(index < HISTOGRAM_BUCKETS);
+
+	if (index < (2U * HISTOGRAM_SUB_BUCKETS))
+		return index;
+
+	unsigned int shift = index / HISTOGRAM_SUB_BUCKETS - 1U;
+	unsigned int sub   = index % HISTOGRAM_SUB_BUCKETS + HISTOGRAM_SUB_BUCKETS;
+
+	return sub << shift;
+}
@@ -0,0 +1,86 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(HISTOGRAM_H)
+#define	HISTOGRAM_H
+
+#include <nlohmann/json.hpp>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+const unsigned int HISTOGRAM_SUB_BITS    = 4U;
+const unsigned int HISTOGRAM_SUB_BUCKETS = 1U << HISTOGRAM_SUB_BITS;
+const unsigned int HISTOGRAM_BUCKETS     = (32U - HISTOGRAM_SUB_BITS + 1U) * HISTOGRAM_SUB_BUCKETS;
+
+// A log-linear histogram in the style of HdrHistogram. Each power of two is
+// split into 16 linear sub-buckets, so any value is recorded to within about
+// 6%, and adding a value is a constant time operation.
+class CHistogram {
+public:
+	CHistogram();
+	~CHistogram();
+
+	void add(unsigned int value)
+	{
+		m_buckets[index(value)]++;
+		m_count++;
+		m_total += value;
+
+		if (value < m_min)
+			m_min = value;
+		if (value > m_max)
+			m_max = value;
+	}
+
+	unsigned int getCount() const;
+	unsigned int getPercentile(unsigned int percent) const;
+
+	// The count, minimum, mean, percentiles and maximum, then the non-empty buckets
+	void write(nlohmann::json& json) const;
+
+	void reset();
+
+private:
+	unsigned int       m_buckets[HISTOGRAM_BUCKETS];
+	unsigned int       m_count;
+	unsigned long long m_total;
+	unsigned int       m_min;
+	unsigned int       m_max;
+
+	static unsigned int index(unsigned int value)
+	{
+		if (value < (2U * HISTOGRAM_SUB_BUCKETS))
+			return value;
+
+#if defined(_MSC_VER)
+		unsigned long msb;
+		_BitScanReverse(&msb, value);
+#else
+		unsigned int msb = 31U - __builtin_clz(value);
+#endif
+		unsigned int shift = msb - HISTOGRAM_SUB_BITS;
+
+		return (shift + 1U) * HISTOGRAM_SUB_BUCKETS + (value >> shift) - HISTOGRAM_SUB_BUCKETS;
+	}
+
+	static unsigned int value(unsigned int index);
+};
+
+#endif
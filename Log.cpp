@@ -1,5 +1,5 @@
 /*
- *   Copyright (C) 2015,2016,2020,2022,2023,2025 by Jonathan Naylor G4KLX
+ *   Copyright (C) 2015,2016,2020,2022,2023,2025,2026 by Jonathan Naylor G4KLX
  *
  *   This program is free software; you can redistribute it and/or modify
  *   it under the terms of the GNU General Public License as published by
@@ -17,81 +17,176 @@
  */
 
 #include "Log.h"
+#include "LogWriter.h"
 #include "MQTTConnection.h"
 
-#if defined(_WIN32) || defined(_WIN64)
-#include <Windows.h>
-#else
-#include <sys/time.h>
-#include <unistd.h>
-#endif
-
 #include <cstdio>
 #include <cstdlib>
-#include <cstdarg>
-#include <ctime>
 #include <cassert>
 #include <cstring>
 
-CMQTTConnection* m_mqtt = nullptr;
+const unsigned int LOG_QUEUE_LENGTH = 512U;
 
-static unsigned int m_mqttLevel = 2U;
+CMQTTConnection* m_mqtt = nullptr;
 
-static unsigned int m_displayLevel = 2U;
+unsigned int m_logLevel = 2U;
 
-static char LEVELS[] = " DMIWEF";
+static CLogWriter* m_writer = nullptr;
 
 void LogInitialise(unsigned int displayLevel, unsigned int mqttLevel)
 {
-	m_mqttLevel    = mqttLevel;
-	m_displayLevel = displayLevel;
+	if (m_writer == nullptr)
+		m_writer = new CLogWriter(LOG_QUEUE_LENGTH);
+
+	m_writer->stop();
+	m_writer->setLevels(displayLevel, mqttLevel);
+
+	m_logLevel = 6U;
+	if (displayLevel != 0U && displayLevel < m_logLevel)
+		m_logLevel = displayLevel;
+	if (mqttLevel != 0U && mqttLevel < m_logLevel)
+		m_logLevel = mqttLevel;
+
+	bool ret = m_writer->run();
+	if (!ret)
+		::fprintf(stderr, "Unable to start the log writer thread, logging synchronously\n");
 }
 
 void LogFinalise()
 {
+	// Any further logging is done synchronously
+	if (m_writer != nullptr)
+		m_writer->stop();
+
 	if (m_mqtt != nullptr) {
 		m_mqtt->close();
+
+		unsigned int buffered = m_mqtt->getBuffered();
+
 		delete m_mqtt;
 		m_mqtt = nullptr;
+
+		// Logged once MQTT has gone, as the line would otherwise be buffered there
+		if (buffered > 0U)
+			LogWarning("MQTT: %u buffered messages were not sent", buffered);
 	}
 }
 
-void Log(unsigned int level, const char* fmt, ...)
+unsigned int LogDropped()
+{
+	if (m_writer == nullptr)
+		return 0U;
+
+	return m_writer->getDropped();
+}
+
+CLogRecord* LogBegin(unsigned int level, const char* fmt, CLogRecord* local, CLogLimiter* limiter)
 {
 	assert(fmt != nullptr);
+	assert(local != nullptr);
 
-	char buffer[501U];
-#if defined(_WIN32) || defined(_WIN64)
-	SYSTEMTIME st;
-	::GetSystemTime(&st);
+	if (level != 6U && !LogEnabled(level))
+		return nullptr;
 
-	::sprintf(buffer, "%c: %04u-%02u-%02u %02u:%02u:%02u.%03u ", LEVELS[level], st.wYear, st.wMonth, st.wDay, st.wHour, st.wMinute, st.wSecond, st.wMilliseconds);
-#else
-	struct timeval now;
-	::gettimeofday(&now, nullptr);
+	if (m_writer == nullptr)
+		m_writer = new CLogWriter(LOG_QUEUE_LENGTH);
 
-	struct tm* tm = ::gmtime(&now.tv_sec);
+	CLogRecord* record = m_writer->reserve(level, local);
+	if (record == nullptr)
+		return nullptr;
 
-	::sprintf(buffer, "%c: %04d-%02d-%02d %02d:%02d:%02d.%03lld ", LEVELS[level], tm->tm_year + 1900, tm->tm_mon + 1, tm->tm_mday, tm->tm_hour, tm->tm_min, tm->tm_sec, now.tv_usec / 1000LL);
-#endif
+	record->m_level   = level;
+	record->m_time    = CLogWriter::now();
+	record->m_format  = fmt;
+	record->m_limiter = limiter;
+	record->m_length  = 0U;
 
-	va_list vl;
-	va_start(vl, fmt);
+	return record;
+}
 
-	::vsnprintf(buffer + ::strlen(buffer), 500 - ::strlen(buffer), fmt, vl);
+void LogEnd(CLogRecord* record)
+{
+	assert(record != nullptr);
 
-	va_end(vl);
+	unsigned int level = record->m_level;
 
-	if (m_mqtt != nullptr && level >= m_mqttLevel && m_mqttLevel != 0U)
-		m_mqtt->publish("log", buffer);
+	m_writer->commit(record);
 
-	if (level >= m_displayLevel && m_displayLevel != 0U) {
-		::fprintf(stdout, "%s\n", buffer);
-		::fflush(stdout);
+	if (level == 6U) {		// Fatal
+		m_writer->stop();
+		exit(1);
 	}
+}
 
-	if (level == 6U)		// Fatal
-		exit(1);
+void LogSigned(CLogRecord* record, long long value, unsigned int size)
+{
+	assert(record != nullptr);
+
+	if ((record->m_length + 10U) > LOG_DATA_LENGTH)
+		return;
+
+	unsigned char* p = record->m_data + record->m_length;
+	p[0U] = 'i';
+	p[1U] = size;
+	::memcpy(p + 2U, &value, sizeof(long long));
+
+	record->m_length += 10U;
+}
+
+void LogUnsigned(CLogRecord* record, unsigned long long value, unsigned int size)
+{
+	assert(record != nullptr);
+
+	if ((record->m_length + 10U) > LOG_DATA_LENGTH)
+		return;
+
+	unsigned char* p = record->m_data + record->m_length;
+	p[0U] = 'u';
+	p[1U] = size;
+	::memcpy(p + 2U, &value, sizeof(unsigned long long));
+
+	record->m_length += 10U;
+}
+
+void LogDouble(CLogRecord* record, double value)
+{
+	assert(record != nullptr);
+
+	if ((record->m_length + 9U) > LOG_DATA_LENGTH)
+		return;
+
+	unsigned char* p = record->m_data + record->m_length;
+	p[0U] = 'd';
+	::memcpy(p + 1U, &value, sizeof(double));
+
+	record->m_length += 9U;
+}
+
+void LogString(CLogRecord* record, const char* value)
+{
+	assert(record != nullptr);
+
+	if (value == nullptr)
+		value = "(null)";
+
+	// Room for the tag, length and the terminating null
+	if ((record->m_length + 4U) > LOG_DATA_LENGTH)
+		return;
+
+	unsigned int space = LOG_DATA_LENGTH - record->m_length - 4U;
+
+	unsigned int len = 0U;
+	while (len < space && value[len] != '\0')
+		len++;
+
+	unsigned char* p = record->m_data + record->m_length;
+	p[0U] = 's';
+	p[1U] = (len + 1U) & 0xFFU;
+	p[2U] = (len + 1U) >> 8;
+	::memcpy(p + 3U, value, len);
+	p[len + 3U] = '\0';
+
+	record->m_length += len + 4U;
 }
 
 void WriteJSON(const std::string& topLevel, nlohmann::json& json)
@@ -104,4 +199,3 @@ void WriteJSON(const std::string& topLevel, nlohmann::json& json)
 		m_mqtt->publish("json", top.dump());
 	}
 }
-
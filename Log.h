@@ -1,5 +1,5 @@
 /*
- *   Copyright (C) 2015,2016,2020,2022,2023 by Jonathan Naylor G4KLX
+ *   Copyright (C) 2015,2016,2020,2022,2023,2026 by Jonathan Naylor G4KLX
  *
  *   This program is free software; you can redistribute it and/or modify
  *   it under the terms of the GNU General Public License as published by
@@ -19,22 +19,138 @@
 #if !defined(LOG_H)
 #define	LOG_H
 
+#include "LogLimiter.h"
+
 #include <string>
+#include <atomic>
+#include <type_traits>
 
 #include <nlohmann/json.hpp>
 
-#define	LogDebug(fmt, ...)	Log(1U, fmt, ##__VA_ARGS__)
-#define	LogMessage(fmt, ...)	Log(2U, fmt, ##__VA_ARGS__)
-#define	LogInfo(fmt, ...)	Log(3U, fmt, ##__VA_ARGS__)
-#define	LogWarning(fmt, ...)	Log(4U, fmt, ##__VA_ARGS__)
-#define	LogError(fmt, ...)	Log(5U, fmt, ##__VA_ARGS__)
+// The level is checked before any of the arguments are evaluated
+#define	LogDebug(fmt, ...)	do { if (LogEnabled(1U)) Log(1U, fmt, ##__VA_ARGS__); } while (0)
+#define	LogMessage(fmt, ...)	do { if (LogEnabled(2U)) Log(2U, fmt, ##__VA_ARGS__); } while (0)
+#define	LogInfo(fmt, ...)	do { if (LogEnabled(3U)) Log(3U, fmt, ##__VA_ARGS__); } while (0)
+#define	LogWarning(fmt, ...)	do { if (LogEnabled(4U)) Log(4U, fmt, ##__VA_ARGS__); } while (0)
+#define	LogError(fmt, ...)	do { if (LogEnabled(5U)) Log(5U, fmt, ##__VA_ARGS__); } while (0)
 #define	LogFatal(fmt, ...)	Log(6U, fmt, ##__VA_ARGS__)
 
-extern void Log(unsigned int level, const char* fmt, ...);
+// For messages that may repeat rapidly, only the first is logged and then a count of the repeats
+#define	LogDebugLimited(fmt, ...)	do { static CLogLimiter logLimiter_(1U); if (LogEnabled(1U) && logLimiter_.check()) LogLimited(&logLimiter_, fmt, ##__VA_ARGS__); } while (0)
+#define	LogMessageLimited(fmt, ...)	do { static CLogLimiter logLimiter_(2U); if (LogEnabled(2U) && logLimiter_.check()) LogLimited(&logLimiter_, fmt, ##__VA_ARGS__); } while (0)
+#define	LogInfoLimited(fmt, ...)	do { static CLogLimiter logLimiter_(3U); if (LogEnabled(3U) && logLimiter_.check()) LogLimited(&logLimiter_, fmt, ##__VA_ARGS__); } while (0)
+#define	LogWarningLimited(fmt, ...)	do { static CLogLimiter logLimiter_(4U); if (LogEnabled(4U) && logLimiter_.check()) LogLimited(&logLimiter_, fmt, ##__VA_ARGS__); } while (0)
+#define	LogErrorLimited(fmt, ...)	do { static CLogLimiter logLimiter_(5U); if (LogEnabled(5U) && logLimiter_.check()) LogLimited(&logLimiter_, fmt, ##__VA_ARGS__); } while (0)
+
+const unsigned int LOG_DATA_LENGTH = 400U;
+
+// The arguments are held in m_data in their raw form and are only turned
+// into text by the writer thread, m_format must be a string literal.
+struct CLogRecord {
+	std::atomic<unsigned int> m_sequence;
+	unsigned int              m_position;
+	unsigned int              m_level;
+	unsigned long long        m_time;
+	const char*               m_format;
+	CLogLimiter*              m_limiter;
+	unsigned int              m_length;
+	unsigned char             m_data[LOG_DATA_LENGTH];
+};
+
+// In Log.cpp, the lowest level that is written anywhere
+extern unsigned int m_logLevel;
+
+inline bool LogEnabled(unsigned int level)
+{
+	return level >= m_logLevel;
+}
+
+extern CLogRecord* LogBegin(unsigned int level, const char* fmt, CLogRecord* local, CLogLimiter* limiter = nullptr);
+extern void LogEnd(CLogRecord* record);
+
+extern void LogSigned(CLogRecord* record, long long value, unsigned int size);
+extern void LogUnsigned(CLogRecord* record, unsigned long long value, unsigned int size);
+extern void LogDouble(CLogRecord* record, double value);
+extern void LogString(CLogRecord* record, const char* value);
+
+inline void LogArgument(CLogRecord* record, const char* value)
+{
+	LogString(record, value);
+}
+
+inline void LogArgument(CLogRecord* record, const unsigned char* value)
+{
+	LogString(record, (const char*)value);
+}
+
+inline void LogArgument(CLogRecord* record, const std::string& value)
+{
+	LogString(record, value.c_str());
+}
+
+template<typename T>
+typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type LogArgument(CLogRecord* record, T value)
+{
+	LogSigned(record, (long long)value, sizeof(T));
+}
+
+template<typename T>
+typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type LogArgument(CLogRecord* record, T value)
+{
+	LogUnsigned(record, (unsigned long long)value, sizeof(T));
+}
+
+template<typename T>
+typename std::enable_if<std::is_floating_point<T>::value>::type LogArgument(CLogRecord* record, T value)
+{
+	LogDouble(record, double(value));
+}
+
+inline void LogArguments(CLogRecord*)
+{
+}
+
+template<typename T, typename... Args>
+void LogArguments(CLogRecord* record, const T& value, const Args&... args)
+{
+	LogArgument(record, value);
+	LogArguments(record, args...);
+}
+
+// The arguments are copied in their raw form, and formatted by the log writer
+template<typename... Args>
+void Log(unsigned int level, const char* fmt, const Args&... args)
+{
+	// Only used if the record has to be written synchronously
+	CLogRecord local;
+	CLogRecord* record = LogBegin(level, fmt, &local);
+	if (record == nullptr)
+		return;
+
+	LogArguments(record, args...);
+
+	LogEnd(record);
+}
+
+template<typename... Args>
+void LogLimited(CLogLimiter* limiter, const char* fmt, const Args&... args)
+{
+	// Only used if the record has to be written synchronously
+	CLogRecord local;
+	CLogRecord* record = LogBegin(limiter->getLevel(), fmt, &local, limiter);
+	if (record == nullptr)
+		return;
+
+	LogArguments(record, args...);
+
+	LogEnd(record);
+}
 
 extern void LogInitialise(unsigned int displayLevel, unsigned int mqttLevel);
 extern void LogFinalise();
 
+extern unsigned int LogDropped();
+
 extern void WriteJSON(const std::string& topLevel, nlohmann::json& json);
 
 #endif
@@ -0,0 +1,96 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+// Measures what a logging call costs the caller, for a disabled LogDebug()
+// and an enabled LogMessage(). The log output goes to stdout, so run it as
+// "logbench > /dev/null", and the results are written to stderr.
+//
+// The calls are made in bursts that fit in the log queue, with a pause
+// between them for the writer thread to catch up, so that no records are
+// dropped. Only the Log.h interface is used, so it can be built against
+// older versions of the logging for comparison.
+
+#include "Log.h"
+
+#include <chrono>
+#include <thread>
+
+#include <cstdio>
+#include <cstdlib>
+
+static const char* USAGE = "Usage: logbench [bursts]\n";
+
+static const unsigned int BURST_LENGTH = 400U;
+
+typedef std::chrono::steady_clock CLOCK;
+
+template<typename F>
+static double measure(unsigned int bursts, F call)
+{
+	double total = 0.0;
+
+	for (unsigned int i = 0U; i < bursts; i++) {
+		CLOCK::time_point start = CLOCK::now();
+
+		for (unsigned int j = 0U; j < BURST_LENGTH; j++)
+			call(i, j);
+
+		total += double(std::chrono::duration_cast<std::chrono::nanoseconds>(CLOCK::now() - start).count());
+
+		std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	}
+
+	return total / (double(bursts) * double(BURST_LENGTH));
+}
+
+int main(int argc, char** argv)
+{
+	unsigned int bursts = 100U;
+
+	if (argc > 2) {
+		::fprintf(stderr, "%s", USAGE);
+		return 1;
+	}
+
+	if (argc == 2) {
+		bursts = (unsigned int)::atoi(argv[1]);
+		if (bursts == 0U) {
+			::fprintf(stderr, "%s", USAGE);
+			return 1;
+		}
+	}
+
+	// Messages and above to the display, nothing to MQTT
+	LogInitialise(2U, 0U);
+
+	double disabled = measure(bursts, [](unsigned int i, unsigned int j) {
+		LogDebug("Burst %u call %u, RIC %07u, text \"%s\"", i, j, 1234567U, "abcdefghijklmnopqrstuvwxyz");
+	});
+
+	double enabled = measure(bursts, [](unsigned int i, unsigned int j) {
+		LogMessage("Burst %u call %u, RIC %07u, text \"%s\"", i, j, 1234567U, "abcdefghijklmnopqrstuvwxyz");
+	});
+
+	LogFinalise();
+
+	::fprintf(stderr, "%u bursts of %u calls\n", bursts, BURST_LENGTH);
+	::fprintf(stderr, "Disabled LogDebug()     %8.1f ns per call\n", disabled);
+	::fprintf(stderr, "Enabled LogMessage()    %8.1f ns per call\n", enabled);
+
+	return 0;
+}
@@ -0,0 +1,123 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "LogLimiter.h"
+#include "LogWriter.h"
+
+#include <cassert>
+#include <cstring>
+
+static std::atomic<CLogLimiter*> m_first(nullptr);
+
+static std::atomic<bool> m_summarised(false);
+
+CLogLimiter::CLogLimiter(unsigned int level) :
+m_level(level),
+m_start(0ULL),
+m_count(0U),
+m_text(),
+m_next(nullptr)
+{
+	// Add ourselves to the list seen by the log writer thread
+	m_next = m_first.load();
+	while (!m_first.compare_exchange_weak(m_next, this))
+		;
+}
+
+bool CLogLimiter::start()
+{
+	unsigned long long expected = 0ULL;
+
+	// Another thread may have got here first, in which case this is a repeat
+	if (!m_start.compare_exchange_strong(expected, CLogWriter::now())) {
+		m_count.fetch_add(1U, std::memory_order_relaxed);
+		return false;
+	}
+
+	return true;
+}
+
+bool CLogLimiter::repeat(unsigned long long start)
+{
+	// Without the log writer nothing reports the repeats, log this one in full once the interval is over
+	if (!m_summarised.load(std::memory_order_relaxed)) {
+		unsigned long long now = CLogWriter::now();
+		if ((now - start) >= LOG_REPEAT_INTERVAL && m_start.compare_exchange_strong(start, now)) {
+			m_count.store(0U, std::memory_order_relaxed);
+			return true;
+		}
+	}
+
+	m_count.fetch_add(1U, std::memory_order_relaxed);
+
+	return false;
+}
+
+void CLogLimiter::setSummarised(bool summarised)
+{
+	m_summarised.store(summarised);
+}
+
+void CLogLimiter::setText(const char* text)
+{
+	assert(text != nullptr);
+
+	::strncpy(m_text, text, LOG_LIMITER_TEXT_LENGTH - 1U);
+	m_text[LOG_LIMITER_TEXT_LENGTH - 1U] = '\0';
+}
+
+bool CLogLimiter::summarise(unsigned long long now, unsigned int interval, unsigned int& count, unsigned int& secs)
+{
+	unsigned long long start = m_start.load();
+	if (start == 0ULL || (now - start) < interval)
+		return false;
+
+	count = m_count.exchange(0U);
+	secs  = (unsigned int)((now - start) / 1000ULL);
+
+	if (count > 0U) {
+		// Still repeating, start another interval
+		m_start.store(now);
+		return true;
+	}
+
+	// It has gone quiet, so log the next occurrence in full
+	m_start.compare_exchange_strong(start, 0ULL);
+
+	return false;
+}
+
+unsigned int CLogLimiter::getLevel() const
+{
+	return m_level;
+}
+
+const char* CLogLimiter::getText() const
+{
+	return m_text;
+}
+
+CLogLimiter* CLogLimiter::getNext() const
+{
+	return m_next;
+}
+
+CLogLimiter* CLogLimiter::getFirst()
+{
+	return m_first.load();
+}
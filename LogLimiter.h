@@ -0,0 +1,68 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(LOGLIMITER_H)
+#define	LOGLIMITER_H
+
+#include <atomic>
+
+const unsigned int LOG_LIMITER_TEXT_LENGTH = 200U;
+
+// One of these lives at each rate limited logging call site. The first
+// occurrence is logged and any repeats within the interval are only
+// counted, the log writer thread then reports the count periodically. Only
+// the writer ends an interval while it is running, so that no count is lost,
+// otherwise the interval is ended by the next repeat after it.
+class CLogLimiter {
+public:
+	CLogLimiter(unsigned int level);
+
+	bool check()
+	{
+		unsigned long long start = m_start.load(std::memory_order_relaxed);
+		if (start != 0ULL)
+			return repeat(start);
+
+		return this->start();
+	}
+
+	// These are only called by the log writer thread
+	static void setSummarised(bool summarised);
+
+	void setText(const char* text);
+	bool summarise(unsigned long long now, unsigned int interval, unsigned int& count, unsigned int& secs);
+
+	unsigned int getLevel() const;
+	const char*  getText() const;
+
+	CLogLimiter* getNext() const;
+
+	static CLogLimiter* getFirst();
+
+private:
+	unsigned int                    m_level;
+	std::atomic<unsigned long long> m_start;
+	std::atomic<unsigned int>       m_count;
+	char                            m_text[LOG_LIMITER_TEXT_LENGTH];
+	CLogLimiter*                    m_next;
+
+	bool start();
+	bool repeat(unsigned long long start);
+};
+
+#endif
@@ -0,0 +1,512 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "LogWriter.h"
+#include "MQTTConnection.h"
+#include "Log.h"
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <Windows.h>
+#else
+#include <sys/time.h>
+#endif
+
+#include <cstdio>
+#include <cassert>
+#include <cstring>
+#include <cstdlib>
+#include <ctime>
+
+// In Log.cpp
+extern CMQTTConnection* m_mqtt;
+
+static char LEVELS[] = " DMIWEF";
+
+const unsigned int NO_POSITION = 0xFFFFFFFFU;
+
+CLogWriter::CLogWriter(unsigned int length) :
+CThread(),
+m_displayLevel(2U),
+m_mqttLevel(2U),
+m_records(nullptr),
+m_length(length),
+m_mask(length - 1U),
+m_head(0U),
+m_tail(0U),
+m_dropped(0U),
+m_totalDropped(0U),
+m_stopped(false),
+m_running(false),
+m_mutex(),
+m_overflow(),
+m_repeat(),
+m_prefixTime(0ULL),
+m_prefixSecs(0ULL),
+m_prefix()
+{
+	assert(length > 0U);
+	assert((length & (length - 1U)) == 0U);
+
+	m_records = new CLogRecord[length];
+
+	for (unsigned int i = 0U; i < length; i++)
+		m_records[i].m_sequence.store(i, std::memory_order_relaxed);
+}
+
+CLogWriter::~CLogWriter()
+{
+	delete[] m_records;
+}
+
+void CLogWriter::setLevels(unsigned int displayLevel, unsigned int mqttLevel)
+{
+	assert(!m_running.load());
+
+	m_displayLevel = displayLevel;
+	m_mqttLevel    = mqttLevel;
+}
+
+bool CLogWriter::run()
+{
+	assert(!m_running.load());
+
+	m_stopped.store(false);
+
+	bool ret = CThread::run();
+
+	m_running.store(ret);
+	CLogLimiter::setSummarised(ret);
+
+	return ret;
+}
+
+CLogRecord* CLogWriter::reserve(unsigned int level, CLogRecord* local)
+{
+	assert(local != nullptr);
+
+	if (!m_running.load()) {
+		local->m_position = NO_POSITION;
+		return local;
+	}
+
+	unsigned int position = m_head.load(std::memory_order_relaxed);
+
+	for (;;) {
+		CLogRecord* record = m_records + (position & m_mask);
+
+		unsigned int sequence = record->m_sequence.load(std::memory_order_acquire);
+		int diff = int(sequence - position);
+
+		if (diff == 0) {
+			if (m_head.compare_exchange_weak(position, position + 1U, std::memory_order_relaxed)) {
+				record->m_position = position;
+				return record;
+			}
+		} else if (diff < 0) {
+			// A fatal error must always get through
+			if (level == 6U) {
+				local->m_position = NO_POSITION;
+				return local;
+			}
+
+			// The queue is full, the writer thread is too far behind
+			m_dropped.fetch_add(1U, std::memory_order_relaxed);
+			m_totalDropped.fetch_add(1U, std::memory_order_relaxed);
+			return nullptr;
+		} else {
+			position = m_head.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+void CLogWriter::commit(CLogRecord* record)
+{
+	assert(record != nullptr);
+
+	if (record->m_position == NO_POSITION) {
+		// The writer thread is stopped first, and only one thread writes at a time
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		halt();
+
+		output(record);
+		::fflush(stdout);
+		return;
+	}
+
+	record->m_sequence.store(record->m_position + 1U, std::memory_order_release);
+}
+
+void CLogWriter::stop()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	halt();
+}
+
+void CLogWriter::halt()
+{
+	if (!m_running.load())
+		return;
+
+	m_stopped.store(true);
+
+	wait();
+
+	m_running.store(false);
+	CLogLimiter::setSummarised(false);
+}
+
+unsigned int CLogWriter::getDropped() const
+{
+	return m_totalDropped.load(std::memory_order_relaxed);
+}
+
+void CLogWriter::entry()
+{
+	while (!m_stopped.load()) {
+		if (drain() > 0U)
+			::fflush(stdout);
+
+		CThread::sleep(10U);
+	}
+
+	drain();
+
+	::fflush(stdout);
+}
+
+unsigned int CLogWriter::drain()
+{
+	unsigned int count = 0U;
+
+	for (;;) {
+		CLogRecord* record = m_records + (m_tail & m_mask);
+
+		unsigned int sequence = record->m_sequence.load(std::memory_order_acquire);
+		if (sequence != m_tail + 1U)
+			break;
+
+		output(record);
+
+		record->m_sequence.store(m_tail + m_length, std::memory_order_release);
+		m_tail++;
+		count++;
+	}
+
+	unsigned int dropped = m_dropped.exchange(0U, std::memory_order_relaxed);
+	if (dropped > 0U) {
+		m_overflow.m_level   = 4U;
+		m_overflow.m_time    = now();
+		m_overflow.m_format  = "The log queue is full, %u log records have been dropped";
+		m_overflow.m_limiter = nullptr;
+		m_overflow.m_length  = 0U;
+		::LogArgument(&m_overflow, dropped);
+
+		output(&m_overflow);
+		count++;
+	}
+
+	count += summarise();
+
+	return count;
+}
+
+unsigned int CLogWriter::summarise()
+{
+	unsigned long long time = now();
+	unsigned int count = 0U;
+
+	for (CLogLimiter* limiter = CLogLimiter::getFirst(); limiter != nullptr; limiter = limiter->getNext()) {
+		unsigned int repeats, secs;
+		if (!limiter->summarise(time, LOG_REPEAT_INTERVAL, repeats, secs))
+			continue;
+
+		m_repeat.m_level   = limiter->getLevel();
+		m_repeat.m_time    = time;
+		m_repeat.m_format  = "%s (repeated %u times in %u s)";
+		m_repeat.m_limiter = nullptr;
+		m_repeat.m_length  = 0U;
+		::LogArgument(&m_repeat, limiter->getText());
+		::LogArgument(&m_repeat, repeats);
+		::LogArgument(&m_repeat, secs);
+
+		output(&m_repeat);
+		count++;
+	}
+
+	return count;
+}
+
+void CLogWriter::output(const CLogRecord* record)
+{
+	assert(record != nullptr);
+
+	bool mqtt    = m_mqtt != nullptr && record->m_level >= m_mqttLevel && m_mqttLevel != 0U;
+	bool display = record->m_level >= m_displayLevel && m_displayLevel != 0U;
+	if (!mqtt && !display)
+		return;
+
+	// The date and time are only reformatted when they have changed
+	if (record->m_time != m_prefixTime) {
+		unsigned long long secs = record->m_time / 1000ULL;
+		if (secs != m_prefixSecs) {
+			time_t t = time_t(secs);
+
+			struct tm tm;
+#if defined(_WIN32) || defined(_WIN64)
+			::gmtime_s(&tm, &t);
+#else
+			::gmtime_r(&t, &tm);
+#endif
+			::snprintf(m_prefix, 64U, "%04d-%02d-%02d %02d:%02d:%02d.", tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec);
+			m_prefixSecs = secs;
+		}
+
+		::snprintf(m_prefix + 20U, 10U, "%03u ", (unsigned int)(record->m_time % 1000ULL));
+		m_prefixTime = record->m_time;
+	}
+
+	char buffer[LOG_TEXT_LENGTH + 30U];
+	buffer[0U] = LEVELS[record->m_level];
+	buffer[1U] = ':';
+	buffer[2U] = ' ';
+	::memcpy(buffer + 3U, m_prefix, 24U);
+
+	format(record, buffer + 27U, LOG_TEXT_LENGTH);
+
+	// Keep the text of a rate limited message for its summary
+	if (record->m_limiter != nullptr)
+		record->m_limiter->setText(buffer + 27U);
+
+	if (mqtt)
+		m_mqtt->publish("log", buffer);
+
+	if (display)
+		::fprintf(stdout, "%s\n", buffer);
+}
+
+void CLogWriter::format(const CLogRecord* record, char* text, unsigned int length) const
+{
+	assert(record != nullptr);
+	assert(text != nullptr);
+	assert(length > 0U);
+
+	const char* fmt = record->m_format;
+	const unsigned char* data = record->m_data;
+	const unsigned char* end  = record->m_data + record->m_length;
+
+	unsigned int n = 0U;
+
+	while (*fmt != '\0' && n < (length - 1U)) {
+		if (*fmt != '%') {
+			text[n++] = *fmt++;
+			continue;
+		}
+
+		fmt++;
+
+		if (*fmt == '%') {
+			text[n++] = *fmt++;
+			continue;
+		}
+
+		// Rebuild the conversion without its length modifier, and with any * replaced by its value
+		char spec[30U];
+		unsigned int s = 0U;
+		spec[s++] = '%';
+
+		while (*fmt != '\0' && ::strchr("-+ #0", *fmt) != nullptr && s < 10U)
+			spec[s++] = *fmt++;
+
+		int width = -1;
+		if (*fmt == '*') {
+			fmt++;
+			width = 0;
+			if (data < end && (data[0U] == 'i' || data[0U] == 'u')) {
+				long long value;
+				::memcpy(&value, data + 2U, sizeof(long long));
+				width = int(value);
+				data += 10U;
+			}
+			if (width < 0) {
+				spec[s++] = '-';
+				width = -width;
+			}
+		} else if (*fmt >= '0' && *fmt <= '9') {
+			width = int(::strtol(fmt, (char**)&fmt, 10));
+		}
+
+		int precision = -1;
+		if (*fmt == '.') {
+			fmt++;
+			precision = 0;
+			if (*fmt == '*') {
+				fmt++;
+				if (data < end && (data[0U] == 'i' || data[0U] == 'u')) {
+					long long value;
+					::memcpy(&value, data + 2U, sizeof(long long));
+					precision = int(value);
+					data += 10U;
+				}
+			} else if (*fmt >= '0' && *fmt <= '9') {
+				precision = int(::strtol(fmt, (char**)&fmt, 10));
+			}
+		}
+
+		if (width >= 0)
+			s += ::snprintf(spec + s, 10U, "%d", width);
+		if (precision >= 0)
+			s += ::snprintf(spec + s, 10U, ".%d", precision);
+
+		while (*fmt != '\0' && ::strchr("hlLqjzt", *fmt) != nullptr)
+			fmt++;
+
+		char conv = *fmt;
+		if (conv == '\0')
+			break;
+		fmt++;
+
+		if (data >= end) {
+			n += ::snprintf(text + n, length - n, "(missing)");
+			continue;
+		}
+
+		unsigned char tag = data[0U];
+
+		int ret = 0;
+		switch (conv) {
+			case 'd':
+			case 'i':
+			case 'u':
+			case 'o':
+			case 'x':
+			case 'X':
+			case 'c': {
+					if (tag != 'i' && tag != 'u') {
+						ret = ::snprintf(text + n, length - n, "(?)");
+						break;
+					}
+
+					unsigned int size = data[1U];
+					long long value;
+					::memcpy(&value, data + 2U, sizeof(long long));
+					data += 10U;
+
+					if (conv == 'c') {
+						spec[s++] = 'c';
+						spec[s] = '\0';
+						ret = ::snprintf(text + n, length - n, spec, int(value));
+					} else if (conv == 'd' || conv == 'i') {
+						spec[s++] = 'l';
+						spec[s++] = 'l';
+						spec[s++] = 'd';
+						spec[s] = '\0';
+						ret = ::snprintf(text + n, length - n, spec, value);
+					} else {
+						// A negative value is shown as the unsigned type of the same size
+						unsigned long long uvalue = (unsigned long long)value;
+						if (tag == 'i' && size < 8U)
+							uvalue &= (1ULL << (size * 8U)) - 1ULL;
+
+						spec[s++] = 'l';
+						spec[s++] = 'l';
+						spec[s++] = conv;
+						spec[s] = '\0';
+						ret = ::snprintf(text + n, length - n, spec, uvalue);
+					}
+				}
+				break;
+
+			case 'e':
+			case 'E':
+			case 'f':
+			case 'F':
+			case 'g':
+			case 'G':
+			case 'a':
+			case 'A': {
+					double value = 0.0;
+					if (tag == 'd') {
+						::memcpy(&value, data + 1U, sizeof(double));
+						data += 9U;
+					} else if (tag == 'i' || tag == 'u') {
+						long long temp;
+						::memcpy(&temp, data + 2U, sizeof(long long));
+						value = double(temp);
+						data += 10U;
+					} else {
+						ret = ::snprintf(text + n, length - n, "(?)");
+						break;
+					}
+
+					spec[s++] = conv;
+					spec[s] = '\0';
+					ret = ::snprintf(text + n, length - n, spec, value);
+				}
+				break;
+
+			case 's': {
+					if (tag != 's') {
+						ret = ::snprintf(text + n, length - n, "(?)");
+						break;
+					}
+
+					unsigned int len = data[1U] + data[2U] * 256U;
+					const char* value = (const char*)(data + 3U);
+					data += len + 3U;
+
+					spec[s++] = 's';
+					spec[s] = '\0';
+					ret = ::snprintf(text + n, length - n, spec, value);
+				}
+				break;
+
+			default:
+				ret = ::snprintf(text + n, length - n, "(?)");
+				break;
+		}
+
+		if (ret > 0)
+			n += (unsigned int)ret;
+		if (n >= length)
+			n = length - 1U;
+	}
+
+	text[n] = '\0';
+}
+
+unsigned long long CLogWriter::now()
+{
+#if defined(_WIN32) || defined(_WIN64)
+	FILETIME ft;
+	::GetSystemTimeAsFileTime(&ft);
+
+	ULARGE_INTEGER time;
+	time.LowPart  = ft.dwLowDateTime;
+	time.HighPart = ft.dwHighDateTime;
+
+	// Convert from 100ns intervals since 1601 to milliseconds since 1970
+	return (time.QuadPart - 116444736000000000ULL) / 10000ULL;
+#else
+	struct timeval now;
+	::gettimeofday(&now, nullptr);
+
+	return now.tv_sec * 1000ULL + now.tv_usec / 1000ULL;
+#endif
+}
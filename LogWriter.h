@@ -0,0 +1,83 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(LOGWRITER_H)
+#define	LOGWRITER_H
+
+#include "LogLimiter.h"
+#include "Log.h"
+#include "Thread.h"
+
+#include <atomic>
+#include <mutex>
+
+const unsigned int LOG_TEXT_LENGTH = 480U;
+
+const unsigned int LOG_REPEAT_INTERVAL = 60000U;		// 60s
+
+// A bounded lock-free queue of log records, any thread may add records to
+// it and a single background thread formats and writes them out. When the
+// thread isn't running records are written out immediately, from a record on
+// the caller's stack.
+class CLogWriter : public CThread {
+public:
+	CLogWriter(unsigned int length);
+	virtual ~CLogWriter();
+
+	void setLevels(unsigned int displayLevel, unsigned int mqttLevel);
+
+	virtual bool run();
+
+	CLogRecord* reserve(unsigned int level, CLogRecord* local);
+	void        commit(CLogRecord* record);
+
+	void stop();
+
+	unsigned int getDropped() const;
+
+	virtual void entry();
+
+	static unsigned long long now();
+
+private:
+	unsigned int              m_displayLevel;
+	unsigned int              m_mqttLevel;
+	CLogRecord*               m_records;
+	unsigned int              m_length;
+	unsigned int              m_mask;
+	std::atomic<unsigned int> m_head;
+	unsigned int              m_tail;
+	std::atomic<unsigned int> m_dropped;
+	std::atomic<unsigned int> m_totalDropped;
+	std::atomic<bool>         m_stopped;
+	std::atomic<bool>         m_running;
+	std::mutex                m_mutex;
+	CLogRecord                m_overflow;
+	CLogRecord                m_repeat;
+	unsigned long long        m_prefixTime;
+	unsigned long long        m_prefixSecs;
+	char                      m_prefix[64U];
+
+	void halt();
+	unsigned int drain();
+	unsigned int summarise();
+	void output(const CLogRecord* record);
+	void format(const CLogRecord* record, char* text, unsigned int length) const;
+};
+
+#endif
@@ -1,5 +1,5 @@
 /*
- *   Copyright (C) 2022,2023,2025 by Jonathan Naylor G4KLX
+ *   Copyright (C) 2022,2023,2025,2026 by Jonathan Naylor G4KLX
  *
  *   This program is free software; you can redistribute it and/or modify
  *   it under the terms of the GNU General Public License as published by
@@ -17,6 +17,7 @@
  */
 
 #include "MQTTConnection.h"
+#include "Log.h"
 
 #include <cassert>
 #include <cstdio>
@@ -39,7 +40,21 @@ m_subs(subs),
 m_keepalive(keepalive),
 m_qos(qos),
 m_mosq(nullptr),
-m_connected(false)
+m_connected(false),
+m_batchSize(0U),
+m_batchTimer(1000U),
+m_batches(),
+m_mutex(),
+m_records(0ULL),
+m_recordBytes(0ULL),
+m_messages(0ULL),
+m_messageBytes(0ULL),
+m_buffer(),
+m_bufferSize(0U),
+m_replayRate(0U),
+m_replayCredit(0U),
+m_dropped(0ULL),
+m_replayed(0ULL)
 {
 	assert(!host.empty());
 	assert(port > 0U);
@@ -99,6 +114,22 @@ bool CMQTTConnection::open()
 	return true;
 }
 
+void CMQTTConnection::setBatching(unsigned int time, unsigned int size)
+{
+	assert(size > 0U);
+
+	m_batchTimer.setTimeout(0U, time);
+	m_batchSize = size;
+}
+
+void CMQTTConnection::setBuffering(unsigned int size, unsigned int rate)
+{
+	assert(rate > 0U);
+
+	m_bufferSize = size;
+	m_replayRate = rate;
+}
+
 bool CMQTTConnection::publish(const char* topic, const char* text)
 {
 	assert(topic != nullptr);
@@ -119,31 +150,199 @@ bool CMQTTConnection::publish(const char* topic, const unsigned char* data, unsi
 	assert(topic != nullptr);
 	assert(data != nullptr);
 
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	// Estimate the size of a PUBLISH packet, the fixed and variable headers and the topic
+	m_records.fetch_add(1ULL, std::memory_order_relaxed);
+	m_recordBytes.fetch_add(len + m_name.size() + ::strlen(topic) + 7U, std::memory_order_relaxed);
+
+	if (m_batchSize > 0U) {
+		append(topic, data, len);
+		return true;
+	}
+
+	return send(topic, data, len);
+}
+
+bool CMQTTConnection::publishNow(const char* topic, const std::string& text)
+{
+	assert(topic != nullptr);
+
 	if (!m_connected)
 		return false;
 
+	char topicEx[100U];
+	::snprintf(topicEx, 100U, "%s/%s", m_name.c_str(), topic);
+
+	return ::mosquitto_publish(m_mosq, nullptr, topicEx, (int)text.size(), text.c_str(), static_cast<int>(m_qos), false) == MOSQ_ERR_SUCCESS;
+}
+
+void CMQTTConnection::clock(unsigned int ms)
+{
+	bool replayed = false;
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		m_batchTimer.clock(ms);
+		if (m_batchTimer.isRunning() && m_batchTimer.hasExpired())
+			flush();
+
+		if (!m_buffer.empty())
+			replayed = replay(ms);
+	}
+
+	// Logged outside of the lock, as the log may be published through here
+	if (replayed)
+		LogMessage("MQTT: replayed the buffered messages, %llu replayed and %llu dropped in total", m_replayed.load(), m_dropped.load());
+}
+
+void CMQTTConnection::append(const char* topic, const unsigned char* data, unsigned int len)
+{
+	assert(topic != nullptr);
+	assert(data != nullptr);
+
+	std::string& batch = m_batches[topic];
+
+	if (!batch.empty() && (batch.size() + len + 2U) > m_batchSize)
+		flush();
+
+	// JSON is sent as an array, and everything else as lines of text
+	bool json = ::strcmp(topic, "json") == 0;
+
+	if (!batch.empty())
+		batch.append(json ? "," : "\n");
+	else if (json)
+		batch.append("[");
+
+	batch.append((const char*)data, len);
+
+	if (batch.size() >= m_batchSize)
+		flush();
+	else if (!m_batchTimer.isRunning())
+		m_batchTimer.start();
+}
+
+void CMQTTConnection::flush()
+{
+	for (std::map<std::string, std::string>::iterator it = m_batches.begin(); it != m_batches.end(); ++it) {
+		std::string& batch = it->second;
+		if (batch.empty())
+			continue;
+
+		if (it->first == "json")
+			batch.append("]");
+
+		send(it->first.c_str(), (const unsigned char*)batch.c_str(), (unsigned int)batch.size());
+
+		batch.clear();
+	}
+
+	m_batchTimer.stop();
+}
+
+bool CMQTTConnection::send(const char* topic, const unsigned char* data, unsigned int len)
+{
+	assert(topic != nullptr);
+	assert(data != nullptr);
+
+	// Anything new has to wait behind the messages still to be replayed
+	if (!m_connected || !m_buffer.empty())
+		return store(topic, data, len);
+
+	int rc = write(topic, data, len);
+	if (rc == MOSQ_ERR_NO_CONN)
+		return store(topic, data, len);
+
+	return rc == MOSQ_ERR_SUCCESS;
+}
+
+int CMQTTConnection::write(const char* topic, const unsigned char* data, unsigned int len)
+{
+	assert(topic != nullptr);
+	assert(data != nullptr);
+
+	int rc;
 	if (::strchr(topic, '/') == nullptr) {
 		char topicEx[100U];
 		::sprintf(topicEx, "%s/%s", m_name.c_str(), topic);
 
-		int rc = ::mosquitto_publish(m_mosq, nullptr, topicEx, len, data, static_cast<int>(m_qos), false);
-		if (rc != MOSQ_ERR_SUCCESS) {
-			::fprintf(stderr, "MQTT Error publishing: %s\n", ::mosquitto_strerror(rc));
-			return false;
-		}
+		rc = ::mosquitto_publish(m_mosq, nullptr, topicEx, len, data, static_cast<int>(m_qos), false);
 	} else {
-		int rc = ::mosquitto_publish(m_mosq, nullptr, topic, len, data, static_cast<int>(m_qos), false);
-		if (rc != MOSQ_ERR_SUCCESS) {
-			::fprintf(stderr, "MQTT Error publishing: %s\n", ::mosquitto_strerror(rc));
+		rc = ::mosquitto_publish(m_mosq, nullptr, topic, len, data, static_cast<int>(m_qos), false);
+	}
+
+	if (rc == MOSQ_ERR_SUCCESS) {
+		m_messages.fetch_add(1ULL, std::memory_order_relaxed);
+		m_messageBytes.fetch_add(len + m_name.size() + ::strlen(topic) + 7U, std::memory_order_relaxed);
+	} else if (rc != MOSQ_ERR_NO_CONN) {
+		::fprintf(stderr, "MQTT Error publishing: %s\n", ::mosquitto_strerror(rc));
+	}
+
+	return rc;
+}
+
+bool CMQTTConnection::store(const char* topic, const unsigned char* data, unsigned int len)
+{
+	assert(topic != nullptr);
+	assert(data != nullptr);
+
+	if (m_bufferSize == 0U)
+		return false;
+
+	// Drop the oldest to make room
+	if (m_buffer.size() >= m_bufferSize) {
+		m_buffer.pop_front();
+		m_dropped.fetch_add(1ULL, std::memory_order_relaxed);
+	}
+
+	m_buffer.push_back(std::make_pair(std::string(topic), std::string((const char*)data, len)));
+
+	return true;
+}
+
+bool CMQTTConnection::replay(unsigned int ms)
+{
+	if (!m_connected) {
+		m_replayCredit = 0U;
+		return false;
+	}
+
+	// The credit is in thousandths of a message
+	m_replayCredit += ms * m_replayRate;
+
+	while (m_replayCredit >= 1000U && !m_buffer.empty()) {
+		const std::pair<std::string, std::string>& entry = m_buffer.front();
+
+		// Leave it at the front if we've lost the connection again, any other error won't go away
+		int rc = write(entry.first.c_str(), (const unsigned char*)entry.second.c_str(), (unsigned int)entry.second.size());
+		if (rc == MOSQ_ERR_NO_CONN)
 			return false;
-		}
+
+		m_buffer.pop_front();
+
+		m_replayCredit -= 1000U;
+		if (rc == MOSQ_ERR_SUCCESS)
+			m_replayed.fetch_add(1ULL, std::memory_order_relaxed);
+		else
+			m_dropped.fetch_add(1ULL, std::memory_order_relaxed);
 	}
 
+	if (!m_buffer.empty())
+		return false;
+
+	m_replayCredit = 0U;
+
 	return true;
 }
 
 void CMQTTConnection::close()
 {
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (m_batchSize > 0U)
+		flush();
+
 	if (m_mosq != nullptr) {
 		::mosquitto_disconnect(m_mosq);
 		::mosquitto_loop_stop(m_mosq, true);
@@ -152,6 +351,43 @@ void CMQTTConnection::close()
 	}
 }
 
+unsigned long long CMQTTConnection::getRecords() const
+{
+	return m_records.load(std::memory_order_relaxed);
+}
+
+unsigned long long CMQTTConnection::getRecordBytes() const
+{
+	return m_recordBytes.load(std::memory_order_relaxed);
+}
+
+unsigned long long CMQTTConnection::getMessages() const
+{
+	return m_messages.load(std::memory_order_relaxed);
+}
+
+unsigned long long CMQTTConnection::getMessageBytes() const
+{
+	return m_messageBytes.load(std::memory_order_relaxed);
+}
+
+unsigned int CMQTTConnection::getBuffered()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	return (unsigned int)m_buffer.size();
+}
+
+unsigned long long CMQTTConnection::getDropped() const
+{
+	return m_dropped.load(std::memory_order_relaxed);
+}
+
+unsigned long long CMQTTConnection::getReplayed() const
+{
+	return m_replayed.load(std::memory_order_relaxed);
+}
+
 void CMQTTConnection::onConnect(mosquitto* mosq, void* obj, int rc)
 {
 	assert(mosq != nullptr);
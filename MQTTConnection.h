@@ -19,10 +19,16 @@
 #if !defined(MQTTPUBLISHER_H)
 #define	MQTTPUBLISHER_H
 
+#include "Timer.h"
+
 #include <mosquitto.h>
 
 #include <vector>
 #include <string>
+#include <atomic>
+#include <mutex>
+#include <deque>
+#include <map>
 
 enum class MQTT_QOS : int {
 	AT_MODE_ONCE  = 0,
@@ -37,12 +43,30 @@ public:
 
 	bool open();
 
+	void setBatching(unsigned int time, unsigned int size);
+	void setBuffering(unsigned int size, unsigned int rate);
+
 	bool publish(const char* topic, const char* text);
 	bool publish(const char* topic, const std::string& text);
 	bool publish(const char* topic, const unsigned char* data, unsigned int len);
 
+	// Sent straight to the broker without batching, buffering or taking the lock, for use
+	// by another thread when the main loop may be blocked part way through a publish
+	bool publishNow(const char* topic, const std::string& text);
+
+	void clock(unsigned int ms);
+
+	// Anything still buffered is kept, for getBuffered()
 	void close();
 
+	unsigned long long getRecords() const;
+	unsigned long long getRecordBytes() const;
+	unsigned long long getMessages() const;
+	unsigned long long getMessageBytes() const;
+	unsigned int       getBuffered();
+	unsigned long long getDropped() const;
+	unsigned long long getReplayed() const;
+
 private:
 	std::string    m_host;
 	unsigned short m_port;
@@ -54,7 +78,28 @@ private:
 	unsigned int   m_keepalive;
 	MQTT_QOS       m_qos;
 	mosquitto*     m_mosq;
-	bool           m_connected;
+	std::atomic<bool> m_connected;
+	unsigned int   m_batchSize;
+	CTimer         m_batchTimer;
+	std::map<std::string, std::string> m_batches;
+	std::mutex     m_mutex;
+	std::atomic<unsigned long long> m_records;
+	std::atomic<unsigned long long> m_recordBytes;
+	std::atomic<unsigned long long> m_messages;
+	std::atomic<unsigned long long> m_messageBytes;
+	std::deque<std::pair<std::string, std::string>> m_buffer;
+	unsigned int   m_bufferSize;
+	unsigned int   m_replayRate;
+	unsigned int   m_replayCredit;
+	std::atomic<unsigned long long> m_dropped;
+	std::atomic<unsigned long long> m_replayed;
+
+	bool send(const char* topic, const unsigned char* data, unsigned int len);
+	int  write(const char* topic, const unsigned char* data, unsigned int len);
+	bool store(const char* topic, const unsigned char* data, unsigned int len);
+	bool replay(unsigned int ms);
+	void append(const char* topic, const unsigned char* data, unsigned int len);
+	void flush();
 
 	static void onConnect(mosquitto* mosq, void* obj, int rc);
 	static void onSubscribe(mosquitto* mosq, void* obj, int mid, int qosCount, const int* grantedQOS);
@@ -0,0 +1,147 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "Metrics.h"
+
+#include <cstdio>
+#include <cassert>
+
+CMetrics::CMetrics() :
+m_received(0ULL),
+m_filtered(0ULL),
+m_queued(0ULL),
+m_sent(0ULL),
+m_rejected(0ULL),
+m_injectedDropped(0ULL),
+m_deferred(0ULL),
+m_codewordsSent(0ULL),
+m_codewordsBudget(0ULL),
+m_reconnects(0ULL),
+m_loops(0ULL),
+m_loopTimeTotal(0ULL),
+m_timingEventsDropped(0ULL),
+m_mqttDropped(0ULL),
+m_mqttReplayed(0ULL),
+m_mqttRecords(0ULL),
+m_mqttRecordBytes(0ULL),
+m_mqttMessages(0ULL),
+m_mqttMessageBytes(0ULL),
+m_linkReconnects(0ULL),
+m_queueDepth(0U),
+m_currentSlot(0U),
+m_mmdvmFree(false),
+m_loopTime(0U),
+m_loopTimeMax(0U),
+m_mqttBuffered(0U),
+m_linkRTT(0U),
+m_linkRTTVar(0U),
+m_linkRetransmits(0U),
+m_linkTotalRetransmits(0U),
+m_linkUnacked(0U),
+m_linkLastAck(0U),
+m_timeOffset(0),
+m_timeRTT(0U),
+m_timeDrift(0),
+m_timeCorrection(0),
+m_slotJitter(0U)
+{
+}
+
+CMetrics::~CMetrics()
+{
+}
+
+std::string CMetrics::render()
+{
+	std::string text;
+	text.reserve(4096U);
+
+	counter(text, "dapnet_messages_received_total",  "Messages received from DAPNET and local sources", m_received);
+	counter(text, "dapnet_messages_filtered_total",  "Messages removed by the RIC and regex filters", m_filtered);
+	counter(text, "dapnet_messages_queued_total",    "Messages queued for transmission", m_queued);
+	counter(text, "dapnet_messages_sent_total",      "Messages sent to the MMDVM", m_sent);
+	counter(text, "dapnet_messages_rejected_total",  "Time messages rejected as too old", m_rejected);
+	counter(text, "dapnet_messages_deferred_total",  "Times a message had to wait as there wasn't room in the slot", m_deferred);
+	counter(text, "dapnet_injected_dropped_total",   "Local page requests that were invalid, over quota or didn't fit in the queue", m_injectedDropped);
+	counter(text, "dapnet_codewords_sent_total",     "Codewords sent including preambles", m_codewordsSent);
+	counter(text, "dapnet_codewords_budget_total",   "Codewords available in the scheduled slots", m_codewordsBudget);
+	counter(text, "dapnet_reconnects_total",         "Reconnections to the DAPNET core", m_reconnects);
+	counter(text, "dapnet_loops_total",              "Passes through the main loop", m_loops);
+	counter(text, "dapnet_loop_time_ms_total",       "Time spent in the main loop, excluding the sleep", m_loopTimeTotal);
+	counter(text, "dapnet_timing_events_dropped_total", "Events from the timing thread lost as the main loop had fallen behind", m_timingEventsDropped);
+	counter(text, "dapnet_mqtt_dropped_total",       "MQTT messages dropped while the broker was unavailable", m_mqttDropped);
+	counter(text, "dapnet_mqtt_replayed_total",      "MQTT messages sent once the broker was available again", m_mqttReplayed);
+	counter(text, "dapnet_mqtt_records_total",       "Records published to MQTT, before batching", m_mqttRecords);
+	counter(text, "dapnet_mqtt_record_bytes_total",  "Bytes of the records published to MQTT, before batching", m_mqttRecordBytes);
+	counter(text, "dapnet_mqtt_messages_total",      "Messages sent to the MQTT broker, after batching", m_mqttMessages);
+	counter(text, "dapnet_mqtt_message_bytes_total", "Bytes of the messages sent to the MQTT broker, after batching", m_mqttMessageBytes);
+	counter(text, "dapnet_link_reconnects_total",    "Reconnections to the DAPNET core because the link had degraded", m_linkReconnects);
+
+	gauge(text, "dapnet_queue_depth",          "Messages waiting to be sent", m_queueDepth.load(std::memory_order_relaxed));
+	gauge(text, "dapnet_current_slot",         "The current time slot", m_currentSlot.load(std::memory_order_relaxed));
+	gauge(text, "dapnet_mmdvm_free",           "Whether the MMDVM is free to transmit", m_mmdvmFree.load(std::memory_order_relaxed) ? 1U : 0U);
+	gauge(text, "dapnet_loop_time_ms",         "The time taken by the last pass through the main loop, excluding the sleep", m_loopTime.load(std::memory_order_relaxed));
+	gauge(text, "dapnet_loop_time_max_ms",     "The longest pass through the main loop since the last scrape", m_loopTimeMax.exchange(0U, std::memory_order_relaxed));
+	gauge(text, "dapnet_mqtt_buffered",        "MQTT messages waiting for the broker", m_mqttBuffered.load(std::memory_order_relaxed));
+	gauge(text, "dapnet_link_rtt_us",          "The smoothed round trip time to the DAPNET core", m_linkRTT.load(std::memory_order_relaxed));
+	gauge(text, "dapnet_link_rtt_var_us",      "The variation in the round trip time to the DAPNET core", m_linkRTTVar.load(std::memory_order_relaxed));
+	gauge(text, "dapnet_link_retransmits",     "Unrecovered retransmissions of the oldest segment to the DAPNET core", m_linkRetransmits.load(std::memory_order_relaxed));
+	gauge(text, "dapnet_link_total_retransmits", "Retransmissions over the life of the connection to the DAPNET core", m_linkTotalRetransmits.load(std::memory_order_relaxed));
+	gauge(text, "dapnet_link_unacked",         "Segments sent to the DAPNET core that haven't been acknowledged", m_linkUnacked.load(std::memory_order_relaxed));
+	gauge(text, "dapnet_link_last_ack_ms",     "Time since the DAPNET core last acknowledged anything", m_linkLastAck.load(std::memory_order_relaxed));
+	gauge(text, "dapnet_time_offset_ms",       "The offset of the local clock from the DAPNET core's, added to the local time", m_timeOffset.load(std::memory_order_relaxed));
+	gauge(text, "dapnet_time_rtt_ms",          "The round trip time of the time sync exchange that the offset came from", m_timeRTT.load(std::memory_order_relaxed));
+	gauge(text, "dapnet_time_drift_ppm",       "The drift of the local clock from the DAPNET core's over the sync window", m_timeDrift.load(std::memory_order_relaxed));
+	gauge(text, "dapnet_time_correction",      "The last correction sent by the DAPNET core, in deciseconds", m_timeCorrection.load(std::memory_order_relaxed));
+	gauge(text, "dapnet_slot_jitter_us",       "How long after the last slot boundary the gateway saw it", m_slotJitter.load(std::memory_order_relaxed));
+
+	return text;
+}
+
+void CMetrics::counter(std::string& text, const char* name, const char* help, const std::atomic<unsigned long long>& value) const
+{
+	assert(name != nullptr);
+	assert(help != nullptr);
+
+	char buffer[300U];
+	::snprintf(buffer, 300U, "# HELP %s %s\n# TYPE %s counter\n%s %llu\n", name, help, name, name, value.load(std::memory_order_relaxed));
+
+	text += buffer;
+}
+
+void CMetrics::gauge(std::string& text, const char* name, const char* help, unsigned int value) const
+{
+	assert(name != nullptr);
+	assert(help != nullptr);
+
+	char buffer[300U];
+	::snprintf(buffer, 300U, "# HELP %s %s\n# TYPE %s gauge\n%s %u\n", name, help, name, name, value);
+
+	text += buffer;
+}
+
+void CMetrics::gauge(std::string& text, const char* name, const char* help, int value) const
+{
+	assert(name != nullptr);
+	assert(help != nullptr);
+
+	char buffer[300U];
+	::snprintf(buffer, 300U, "# HELP %s %s\n# TYPE %s gauge\n%s %d\n", name, help, name, name, value);
+
+	text += buffer;
+}
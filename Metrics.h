@@ -0,0 +1,101 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(METRICS_H)
+#define	METRICS_H
+
+#include <atomic>
+#include <string>
+
+// The gateway's counters and gauges. They are updated with relaxed atomic
+// operations so that they can be read at any time without any locking.
+class CMetrics {
+public:
+	CMetrics();
+	~CMetrics();
+
+	// Counters
+	std::atomic<unsigned long long> m_received;
+	std::atomic<unsigned long long> m_filtered;
+	std::atomic<unsigned long long> m_queued;
+	std::atomic<unsigned long long> m_sent;
+	std::atomic<unsigned long long> m_rejected;
+	std::atomic<unsigned long long> m_injectedDropped;
+	std::atomic<unsigned long long> m_deferred;
+	std::atomic<unsigned long long> m_codewordsSent;
+	std::atomic<unsigned long long> m_codewordsBudget;
+	std::atomic<unsigned long long> m_reconnects;
+	std::atomic<unsigned long long> m_loops;
+	std::atomic<unsigned long long> m_loopTimeTotal;
+	std::atomic<unsigned long long> m_timingEventsDropped;
+	std::atomic<unsigned long long> m_mqttDropped;
+	std::atomic<unsigned long long> m_mqttReplayed;
+	std::atomic<unsigned long long> m_mqttRecords;
+	std::atomic<unsigned long long> m_mqttRecordBytes;
+	std::atomic<unsigned long long> m_mqttMessages;
+	std::atomic<unsigned long long> m_mqttMessageBytes;
+	std::atomic<unsigned long long> m_linkReconnects;
+
+	// Gauges
+	std::atomic<unsigned int>       m_queueDepth;
+	std::atomic<unsigned int>       m_currentSlot;
+	std::atomic<bool>               m_mmdvmFree;
+	std::atomic<unsigned int>       m_loopTime;
+	std::atomic<unsigned int>       m_loopTimeMax;
+	std::atomic<unsigned int>       m_mqttBuffered;
+	std::atomic<unsigned int>       m_linkRTT;
+	std::atomic<unsigned int>       m_linkRTTVar;
+	std::atomic<unsigned int>       m_linkRetransmits;
+	std::atomic<unsigned int>       m_linkTotalRetransmits;
+	std::atomic<unsigned int>       m_linkUnacked;
+	std::atomic<unsigned int>       m_linkLastAck;
+	std::atomic<int>                m_timeOffset;
+	std::atomic<unsigned int>       m_timeRTT;
+	std::atomic<int>                m_timeDrift;
+	std::atomic<int>                m_timeCorrection;
+	std::atomic<unsigned int>       m_slotJitter;
+
+	void add(std::atomic<unsigned long long>& counter, unsigned long long n = 1ULL)
+	{
+		counter.fetch_add(n, std::memory_order_relaxed);
+	}
+
+	template <typename T, typename U> void set(std::atomic<T>& gauge, U value)
+	{
+		gauge.store(T(value), std::memory_order_relaxed);
+	}
+
+	void setLoopTime(unsigned int ms)
+	{
+		m_loopTime.store(ms, std::memory_order_relaxed);
+		m_loopTimeTotal.fetch_add(ms, std::memory_order_relaxed);
+
+		if (ms > m_loopTimeMax.load(std::memory_order_relaxed))
+			m_loopTimeMax.store(ms, std::memory_order_relaxed);
+	}
+
+	// In the Prometheus text exposition format, the maximum loop time is reset by each call
+	std::string render();
+
+private:
+	void counter(std::string& text, const char* name, const char* help, const std::atomic<unsigned long long>& value) const;
+	void gauge(std::string& text, const char* name, const char* help, unsigned int value) const;
+	void gauge(std::string& text, const char* name, const char* help, int value) const;
+};
+
+#endif
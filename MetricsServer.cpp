@@ -0,0 +1,313 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "MetricsServer.h"
+#include "Log.h"
+
+#include <cassert>
+#include <cstring>
+
+#if defined(_WIN32) || defined(_WIN64)
+#define	INVALID_FD	INVALID_SOCKET
+#define	SEND_FLAGS	0
+#define	poll		WSAPoll
+#else
+#include <fcntl.h>
+#define	INVALID_FD	-1
+#define	SEND_FLAGS	MSG_NOSIGNAL
+#endif
+
+CMetricsServer::CMetricsServer(const std::string& address, unsigned short port, CMetrics& metrics) :
+m_address(address),
+m_port(port),
+m_metrics(metrics),
+m_fd(INVALID_FD),
+m_clients()
+{
+	assert(port > 0U);
+
+	for (unsigned int i = 0U; i < METRICS_MAX_CLIENTS; i++)
+		m_clients[i].m_fd = INVALID_FD;
+}
+
+CMetricsServer::~CMetricsServer()
+{
+}
+
+bool CMetricsServer::open()
+{
+	assert(m_fd == INVALID_FD);
+
+	sockaddr_storage addr;
+	unsigned int addrlen;
+	struct addrinfo hints;
+
+	::memset(&hints, 0, sizeof(hints));
+	hints.ai_flags    = AI_PASSIVE;
+	hints.ai_family   = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+
+	if (CUDPSocket::lookup(m_address, m_port, addr, addrlen, hints) != 0) {
+		LogError("The metrics address is invalid - %s", m_address.c_str());
+		return false;
+	}
+
+	m_fd = ::socket(addr.ss_family, SOCK_STREAM, 0);
+	if (m_fd == INVALID_FD) {
+#if defined(_WIN32) || defined(_WIN64)
+		LogError("Cannot create the metrics socket, err: %lu", ::GetLastError());
+#else
+		LogError("Cannot create the metrics socket, err: %d", errno);
+#endif
+		return false;
+	}
+
+	int reuse = 1;
+	if (::setsockopt(m_fd, SOL_SOCKET, SO_REUSEADDR, (char *)&reuse, sizeof(reuse)) == -1) {
+#if defined(_WIN32) || defined(_WIN64)
+		LogError("Cannot set the metrics socket option, err: %lu", ::GetLastError());
+#else
+		LogError("Cannot set the metrics socket option, err: %d", errno);
+#endif
+		close();
+		return false;
+	}
+
+	if (!setNonBlocking(m_fd)) {
+#if defined(_WIN32) || defined(_WIN64)
+		LogError("Cannot make the metrics socket non-blocking, err: %lu", ::GetLastError());
+#else
+		LogError("Cannot make the metrics socket non-blocking, err: %d", errno);
+#endif
+		close();
+		return false;
+	}
+
+	if (::bind(m_fd, (sockaddr*)&addr, addrlen) == -1) {
+#if defined(_WIN32) || defined(_WIN64)
+		LogError("Cannot bind the metrics address, err: %lu", ::GetLastError());
+#else
+		LogError("Cannot bind the metrics address, err: %d", errno);
+#endif
+		close();
+		return false;
+	}
+
+	if (::listen(m_fd, (int)METRICS_MAX_CLIENTS) == -1) {
+#if defined(_WIN32) || defined(_WIN64)
+		LogError("Cannot listen on the metrics socket, err: %lu", ::GetLastError());
+#else
+		LogError("Cannot listen on the metrics socket, err: %d", errno);
+#endif
+		close();
+		return false;
+	}
+
+	LogMessage("Serving metrics on %s:%hu", m_address.c_str(), m_port);
+
+	return true;
+}
+
+void CMetricsServer::clock(unsigned int ms)
+{
+	if (m_fd == INVALID_FD)
+		return;
+
+	accept();
+
+	for (unsigned int i = 0U; i < METRICS_MAX_CLIENTS; i++) {
+		CMetricsClient& client = m_clients[i];
+		if (client.m_fd == INVALID_FD)
+			continue;
+
+		client.m_time += ms;
+
+		if (!service(client) || client.m_time >= METRICS_CLIENT_TIMEOUT)
+			close(client);
+	}
+}
+
+void CMetricsServer::close()
+{
+	for (unsigned int i = 0U; i < METRICS_MAX_CLIENTS; i++) {
+		if (m_clients[i].m_fd != INVALID_FD)
+			close(m_clients[i]);
+	}
+
+	if (m_fd != INVALID_FD) {
+		closeSocket(m_fd);
+		m_fd = INVALID_FD;
+	}
+}
+
+void CMetricsServer::accept()
+{
+	struct pollfd pfd;
+	pfd.fd      = m_fd;
+	pfd.events  = POLLIN;
+	pfd.revents = 0;
+
+	if (::poll(&pfd, 1, 0) <= 0 || (pfd.revents & POLLIN) == 0)
+		return;
+
+	// The client may have gone before we got to it, the listening socket is non-blocking
+	METRICS_SOCKET fd = ::accept(m_fd, nullptr, nullptr);
+	if (fd == INVALID_FD)
+		return;
+
+	// So that a send to a slow scraper can't hold up the main loop
+	if (!setNonBlocking(fd)) {
+		closeSocket(fd);
+		return;
+	}
+
+	for (unsigned int i = 0U; i < METRICS_MAX_CLIENTS; i++) {
+		CMetricsClient& client = m_clients[i];
+		if (client.m_fd == INVALID_FD) {
+			client.m_fd   = fd;
+			client.m_sent = 0U;
+			client.m_time = 0U;
+			client.m_request.clear();
+			client.m_response.clear();
+			return;
+		}
+	}
+
+	// Too many clients, the scraper will try again
+	closeSocket(fd);
+}
+
+bool CMetricsServer::service(CMetricsClient& client)
+{
+	struct pollfd pfd;
+	pfd.fd      = client.m_fd;
+	pfd.events  = client.m_response.empty() ? POLLIN : POLLOUT;
+	pfd.revents = 0;
+
+	int ret = ::poll(&pfd, 1, 0);
+	if (ret < 0)
+		return false;
+	if (ret == 0)
+		return true;
+
+	if ((pfd.revents & (POLLERR | POLLHUP | POLLNVAL)) != 0)
+		return false;
+
+	if (client.m_response.empty()) {
+		char buffer[512U];
+#if defined(_WIN32) || defined(_WIN64)
+		int len = ::recv(client.m_fd, buffer, sizeof(buffer), 0);
+#else
+		ssize_t len = ::recv(client.m_fd, buffer, sizeof(buffer), 0);
+#endif
+		if (len < 0 && wouldBlock())
+			return true;
+		if (len <= 0)
+			return false;
+
+		client.m_request.append(buffer, len);
+
+		if (client.m_request.find("\r\n\r\n") != std::string::npos || client.m_request.find("\n\n") != std::string::npos)
+			respond(client);
+		else if (client.m_request.size() > METRICS_MAX_REQUEST)
+			return false;
+
+		return true;
+	}
+
+	unsigned int remaining = (unsigned int)client.m_response.size() - client.m_sent;
+#if defined(_WIN32) || defined(_WIN64)
+	int len = ::send(client.m_fd, client.m_response.c_str() + client.m_sent, remaining, SEND_FLAGS);
+#else
+	ssize_t len = ::send(client.m_fd, client.m_response.c_str() + client.m_sent, remaining, SEND_FLAGS);
+#endif
+	// The window is full, the rest goes on a later pass
+	if (len < 0 && wouldBlock())
+		return true;
+	if (len <= 0)
+		return false;
+
+	client.m_sent += (unsigned int)len;
+
+	// Done once it has all gone, HTTP/1.0 without keep-alive
+	return client.m_sent < client.m_response.size();
+}
+
+void CMetricsServer::respond(CMetricsClient& client)
+{
+	std::string status;
+	std::string body;
+
+	if (client.m_request.compare(0U, 13U, "GET /metrics ") == 0 || client.m_request.compare(0U, 13U, "GET /metrics?") == 0) {
+		status = "200 OK";
+		body   = m_metrics.render();
+	} else if (client.m_request.compare(0U, 4U, "GET ") == 0) {
+		status = "404 Not Found";
+		body   = "Not Found\n";
+	} else {
+		status = "405 Method Not Allowed";
+		body   = "Method Not Allowed\n";
+	}
+
+	client.m_response  = "HTTP/1.0 " + status + "\r\n";
+	client.m_response += "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n";
+	client.m_response += "Content-Length: " + std::to_string(body.size()) + "\r\n";
+	client.m_response += "Connection: close\r\n\r\n";
+	client.m_response += body;
+}
+
+void CMetricsServer::close(CMetricsClient& client)
+{
+	closeSocket(client.m_fd);
+
+	client.m_fd = INVALID_FD;
+	client.m_request.clear();
+	client.m_response.clear();
+}
+
+void CMetricsServer::closeSocket(METRICS_SOCKET fd) const
+{
+#if defined(_WIN32) || defined(_WIN64)
+	::closesocket(fd);
+#else
+	::close(fd);
+#endif
+}
+
+bool CMetricsServer::setNonBlocking(METRICS_SOCKET fd) const
+{
+#if defined(_WIN32) || defined(_WIN64)
+	u_long mode = 1UL;
+	return ::ioctlsocket(fd, FIONBIO, &mode) == 0;
+#else
+	int flags = ::fcntl(fd, F_GETFL, 0);
+	if (flags == -1)
+		return false;
+
+	return ::fcntl(fd, F_SETFL, flags | O_NONBLOCK) != -1;
+#endif
+}
+
+bool CMetricsServer::wouldBlock() const
+{
+#if defined(_WIN32) || defined(_WIN64)
+	return ::WSAGetLastError() == WSAEWOULDBLOCK;
+#else
+	return errno == EAGAIN || errno == EWOULDBLOCK;
+#endif
+}
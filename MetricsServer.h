@@ -0,0 +1,75 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(METRICSSERVER_H)
+#define	METRICSSERVER_H
+
+#include "UDPSocket.h"
+#include "Metrics.h"
+
+#include <string>
+
+const unsigned int METRICS_MAX_CLIENTS    = 8U;
+const unsigned int METRICS_MAX_REQUEST    = 2048U;
+const unsigned int METRICS_CLIENT_TIMEOUT = 2000U;
+
+// A minimal HTTP/1.0 server for Prometheus scrapes of /metrics. It is polled
+// from the main loop and never blocks, a slow or idle client is dropped after
+// two seconds.
+class CMetricsServer {
+public:
+	CMetricsServer(const std::string& address, unsigned short port, CMetrics& metrics);
+	~CMetricsServer();
+
+	bool open();
+
+	void clock(unsigned int ms);
+
+	void close();
+
+private:
+#if defined(_WIN32) || defined(_WIN64)
+	typedef SOCKET METRICS_SOCKET;
+#else
+	typedef int    METRICS_SOCKET;
+#endif
+
+	struct CMetricsClient {
+		METRICS_SOCKET m_fd;
+		std::string    m_request;
+		std::string    m_response;
+		unsigned int   m_sent;
+		unsigned int   m_time;
+	};
+
+	std::string    m_address;
+	unsigned short m_port;
+	CMetrics&      m_metrics;
+	METRICS_SOCKET m_fd;
+	CMetricsClient m_clients[METRICS_MAX_CLIENTS];
+
+	void accept();
+	bool service(CMetricsClient& client);
+	void respond(CMetricsClient& client);
+	void close(CMetricsClient& client);
+	void closeSocket(METRICS_SOCKET fd) const;
+	bool setNonBlocking(METRICS_SOCKET fd) const;
+	bool wouldBlock() const;
+};
+
+#endif
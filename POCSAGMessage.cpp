@@ -1,5 +1,5 @@
 /*
-*   Copyright (C) 2018,2025 by Jonathan Naylor G4KLX
+*   Copyright (C) 2018,2025,2026 by Jonathan Naylor G4KLX
 *
 *   This program is free software; you can redistribute it and/or modify
 *   it under the terms of the GNU General Public License as published by
@@ -21,18 +21,23 @@
 #include <cstdio>
 #include <cassert>
 #include <cstring>
+#include <atomic>
+
+static std::atomic<unsigned int> m_nextId(1U);
 
 CPOCSAGMessage::CPOCSAGMessage(unsigned char type, unsigned int ric, unsigned char functional, unsigned char* message, unsigned int length) :
+m_id(m_nextId.fetch_add(1U)),
 m_type(type),
 m_ric(ric),
 m_functional(functional),
 m_message(nullptr),
 m_length(length),
-m_timeQueued()
+m_timeQueued(),
+m_timeInQueue()
 {
 	assert(functional < 4U);
 	assert(message != nullptr);
-	assert(length > 0U);
+	assert(length > 0U || functional == 1U);
 
 	m_message = new unsigned char[length + 1];
 
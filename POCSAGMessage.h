@@ -1,5 +1,5 @@
 /*
-*   Copyright (C) 2018 by Jonathan Naylor G4KLX
+*   Copyright (C) 2018,2026 by Jonathan Naylor G4KLX
 *
 *   This program is free software; you can redistribute it and/or modify
 *   it under the terms of the GNU General Public License as published by
@@ -29,12 +29,14 @@ public:
 	CPOCSAGMessage(unsigned char type, unsigned int ric, unsigned char functional, unsigned char* message, unsigned int length);
 	~CPOCSAGMessage();
 
+	unsigned int   m_id;
 	unsigned char  m_type;
 	unsigned int   m_ric;
 	unsigned char  m_functional;
 	unsigned char* m_message;
 	unsigned int   m_length;
 	CStopWatch     m_timeQueued;
+	CStopWatch     m_timeInQueue;
 };
 
 #endif
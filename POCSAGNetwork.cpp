@@ -1,5 +1,5 @@
 /*
- *   Copyright (C) 2018,2025 by Jonathan Naylor G4KLX
+ *   Copyright (C) 2018,2025,2026 by Jonathan Naylor G4KLX
  *
  *   This program is free software; you can redistribute it and/or modify
  *   it under the terms of the GNU General Public License as published by
@@ -17,6 +17,9 @@
  */
 
 #include "POCSAGNetwork.h"
+#include "EventLog.h"
+#include "Capture.h"
+#include "Probes.h"
 #include "Utils.h"
 #include "Log.h"
 
@@ -51,7 +54,7 @@ bool CPOCSAGNetwork::open()
 
 	LogMessage("Opening POCSAG network connection");
 
-	return m_socket.open(m_addr);
+	return connect();
 }
 
 bool CPOCSAGNetwork::write(CPOCSAGMessage* message)
@@ -59,41 +62,36 @@ bool CPOCSAGNetwork::write(CPOCSAGMessage* message)
 	assert(message != nullptr);
 
 	unsigned char data[200U];
-	data[0U] = 'P';
-	data[1U] = 'O';
-	data[2U] = 'C';
-	data[3U] = 'S';
-	data[4U] = 'A';
-	data[5U] = 'G';
+	unsigned int length = encode(message, data);
 
-	data[6U] = message->m_ric >> 16;
-	data[7U] = message->m_ric >> 8;
-	data[8U] = message->m_ric >> 0;
+	PROBE3(pocsag_write, message->m_ric, message->m_functional, message->m_length);
 
-	data[9U] = message->m_functional;
+	if (m_debug)
+		CUtils::dump(1U, "POCSAG Network Data Sent", data, length);
 
-	::memcpy(data + 10U, message->m_message, message->m_length);
+	return send(data, length);
+}
 
-	if (m_debug)
-		CUtils::dump(1U, "POCSAG Network Data Sent", data, message->m_length + 10U);
+void CPOCSAGNetwork::writeEvent(const CPOCSAGMessage* message) const
+{
+	assert(message != nullptr);
 
-	return m_socket.write(data, message->m_length + 10U, m_addr, m_addrLen);
+	unsigned char data[200U];
+	unsigned int length = encode(message, data);
+
+	::EventFrame(EVENT_TYPE::POCSAG_TX, data, length);
 }
 
 unsigned int CPOCSAGNetwork::read(unsigned char* data)
 {
 	assert(data != nullptr);
 
-	sockaddr_storage address;
-	unsigned int addrLen;
-	int length = m_socket.read(data, 1U, address, addrLen);
+	int length = receive(data, 1U);
 	if (length <= 0)
 		return 0U;
 
-	if (!CUDPSocket::match(address, m_addr)) {
-		LogWarning("Received a packet from an unknown address");
-		return 0U;
-	}
+	::CaptureFrame(CAPTURE_TYPE::MMDVM_RX, data, length);
+	::EventFrame(EVENT_TYPE::POCSAG_RX, data, length);
 
 	if (m_debug)
 		CUtils::dump(1U, "POCSAG Network Data Received", data, length);
@@ -103,7 +101,65 @@ unsigned int CPOCSAGNetwork::read(unsigned char* data)
 
 void CPOCSAGNetwork::close()
 {
-	m_socket.close();
+	disconnect();
 
 	LogMessage("Closing POCSAG network connection");
 }
+
+bool CPOCSAGNetwork::connect()
+{
+	return m_socket.open(m_addr);
+}
+
+int CPOCSAGNetwork::receive(unsigned char* data, unsigned int length)
+{
+	assert(data != nullptr);
+
+	sockaddr_storage address;
+	unsigned int addrLen;
+	int ret = m_socket.read(data, length, address, addrLen);
+	if (ret <= 0)
+		return ret;
+
+	if (!CUDPSocket::match(address, m_addr)) {
+		LogWarningLimited("Received a packet from an unknown address");
+		return 0;
+	}
+
+	return ret;
+}
+
+bool CPOCSAGNetwork::send(const unsigned char* data, unsigned int length)
+{
+	assert(data != nullptr);
+
+	return m_socket.write(data, length, m_addr, m_addrLen);
+}
+
+unsigned int CPOCSAGNetwork::encode(const CPOCSAGMessage* message, unsigned char* data) const
+{
+	assert(message != nullptr);
+	assert(data != nullptr);
+
+	data[0U] = 'P';
+	data[1U] = 'O';
+	data[2U] = 'C';
+	data[3U] = 'S';
+	data[4U] = 'A';
+	data[5U] = 'G';
+
+	data[6U] = message->m_ric >> 16;
+	data[7U] = message->m_ric >> 8;
+	data[8U] = message->m_ric >> 0;
+
+	data[9U] = message->m_functional;
+
+	::memcpy(data + 10U, message->m_message, message->m_length);
+
+	return message->m_length + 10U;
+}
+
+void CPOCSAGNetwork::disconnect()
+{
+	m_socket.close();
+}
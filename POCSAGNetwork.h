@@ -1,5 +1,5 @@
 /*
- *   Copyright (C) 2018 by Jonathan Naylor G4KLX
+ *   Copyright (C) 2018,2026 by Jonathan Naylor G4KLX
  *
  *   This program is free software; you can redistribute it and/or modify
  *   it under the terms of the GNU General Public License as published by
@@ -28,21 +28,34 @@
 class CPOCSAGNetwork {
 public:
 	CPOCSAGNetwork(const std::string& localAddress, unsigned short localPort, const std::string& remoteAddress, unsigned short remotePort, bool debug);
-	~CPOCSAGNetwork();
+	virtual ~CPOCSAGNetwork();
 
 	bool open();
 
 	bool write(CPOCSAGMessage* message);
 
+	// The frame of a message that has been written, for the event log, kept
+	// apart from write() so that it can be done away from the timing thread
+	void writeEvent(const CPOCSAGMessage* message) const;
+
 	unsigned int read(unsigned char* data);
 
 	void close();
 
+protected:
+	// The UDP link to MMDVMHost, overridden by dapnetsim
+	virtual bool connect();
+	virtual int  receive(unsigned char* data, unsigned int length);
+	virtual bool send(const unsigned char* data, unsigned int length);
+	virtual void disconnect();
+
 private:
 	CUDPSocket       m_socket;
 	sockaddr_storage m_addr;
 	unsigned int     m_addrLen;
 	bool             m_debug;
+
+	unsigned int encode(const CPOCSAGMessage* message, unsigned char* data) const;
 };
 
 #endif
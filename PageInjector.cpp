@@ -0,0 +1,246 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "PageInjector.h"
+#include "Log.h"
+
+#include <nlohmann/json.hpp>
+
+#include <cstdio>
+#include <cassert>
+#include <cstring>
+#include <cctype>
+#include <climits>
+#include <cstdint>
+
+CPageInjector::CPageInjector(unsigned int rate, unsigned int burst, unsigned int queue) :
+m_rate(rate),
+m_burst(burst),
+m_queueSize(queue),
+m_queue(),
+m_buckets(),
+m_stopWatch(),
+m_mutex(),
+m_accepted(0ULL),
+m_invalid(0ULL),
+m_overQuota(0ULL),
+m_queueFull(0ULL)
+{
+	assert(rate > 0U);
+	assert(burst > 0U);
+	assert(queue > 0U);
+
+	m_stopWatch.start();
+}
+
+CPageInjector::~CPageInjector()
+{
+	for (std::deque<CPOCSAGMessage*>::iterator it = m_queue.begin(); it != m_queue.end(); ++it)
+		delete *it;
+}
+
+PAGE_RESULT CPageInjector::write(const unsigned char* data, unsigned int length)
+{
+	assert(data != nullptr);
+
+	std::string source;
+
+	// Do the parsing outside of the lock
+	CPOCSAGMessage* message = nullptr;
+	if (length > 0U && data[0U] == PAGE_BINARY_FORMAT)
+		message = parseBinary(data, length, source);
+	else
+		message = parseJSON(data, length, source);
+
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (message == nullptr) {
+		m_invalid.fetch_add(1ULL, std::memory_order_relaxed);
+		LogWarningLimited("Received an invalid page request");
+		return PAGE_RESULT::INVALID;
+	}
+
+	if (!checkQuota(source)) {
+		m_overQuota.fetch_add(1ULL, std::memory_order_relaxed);
+		LogWarningLimited("Page request from %s is over its quota", source.c_str());
+		delete message;
+		return PAGE_RESULT::OVER_QUOTA;
+	}
+
+	if (m_queue.size() >= m_queueSize) {
+		m_queueFull.fetch_add(1ULL, std::memory_order_relaxed);
+		LogWarningLimited("The page request queue is full");
+		delete message;
+		return PAGE_RESULT::QUEUE_FULL;
+	}
+
+	m_queue.push_back(message);
+	m_accepted.fetch_add(1ULL, std::memory_order_relaxed);
+
+	return PAGE_RESULT::ACCEPTED;
+}
+
+CPOCSAGMessage* CPageInjector::read()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	if (m_queue.empty())
+		return nullptr;
+
+	CPOCSAGMessage* message = m_queue.front();
+	m_queue.pop_front();
+
+	return message;
+}
+
+CPOCSAGMessage* CPageInjector::parseJSON(const unsigned char* data, unsigned int length, std::string& source) const
+{
+	assert(data != nullptr);
+
+	nlohmann::json json = nlohmann::json::parse(data, data + length, nullptr, false);
+	if (json.is_discarded() || !json.is_object())
+		return nullptr;
+
+	if (!json.contains("ric") || !json["ric"].is_number_unsigned())
+		return nullptr;
+	if (json.contains("message") && !json["message"].is_string())
+		return nullptr;
+
+	// Read at full width so that a large value can't be truncated into range
+	uint64_t ric = json["ric"].get<uint64_t>();
+
+	uint64_t functional = 3U;
+	if (json.contains("functional")) {
+		if (!json["functional"].is_number_unsigned())
+			return nullptr;
+		functional = json["functional"].get<uint64_t>();
+	}
+
+	uint64_t type = 6U;
+	if (json.contains("type")) {
+		if (!json["type"].is_number_unsigned())
+			return nullptr;
+		type = json["type"].get<uint64_t>();
+	}
+
+	if (ric > UINT_MAX || functional > UINT_MAX || type > UINT_MAX)
+		return nullptr;
+
+	if (json.contains("source")) {
+		if (!json["source"].is_string())
+			return nullptr;
+		source = json["source"].get<std::string>();
+	}
+
+	std::string message;
+	if (json.contains("message"))
+		message = json["message"].get<std::string>();
+
+	return create((unsigned int)ric, (unsigned int)functional, (unsigned int)type, message);
+}
+
+CPOCSAGMessage* CPageInjector::parseBinary(const unsigned char* data, unsigned int length, std::string& source) const
+{
+	assert(data != nullptr);
+
+	if (length < 7U)
+		return nullptr;
+
+	unsigned int ric        = (data[1U] << 16) | (data[2U] << 8) | data[3U];
+	unsigned int functional = data[4U];
+	unsigned int type       = data[5U];
+	unsigned int sourceLen  = data[6U];
+
+	if ((7U + sourceLen) > length)
+		return nullptr;
+
+	source.assign((const char*)(data + 7U), sourceLen);
+
+	std::string message((const char*)(data + 7U + sourceLen), length - 7U - sourceLen);
+
+	return create(ric, functional, type, message);
+}
+
+CPOCSAGMessage* CPageInjector::create(unsigned int ric, unsigned int functional, unsigned int type, const std::string& message) const
+{
+	if (ric > MAX_RIC || functional > 3U || type > 0xFFU)
+		return nullptr;
+
+	// Only a tone only page can be sent without any text
+	if ((message.empty() && functional != 1U) || message.size() > MAX_PAGE_LENGTH)
+		return nullptr;
+
+	for (std::string::const_iterator it = message.cbegin(); it != message.cend(); ++it) {
+		if (!::isprint((unsigned char)*it))
+			return nullptr;
+	}
+
+	return new CPOCSAGMessage(type, ric, functional, (unsigned char*)message.c_str(), (unsigned int)message.size());
+}
+
+bool CPageInjector::checkQuota(const std::string& source)
+{
+	unsigned int now = m_stopWatch.elapsed();
+
+	std::unordered_map<std::string, CPageBucket>::iterator it = m_buckets.find(source);
+	if (it == m_buckets.end()) {
+		// Don't let an unbounded number of sources use up memory
+		if (m_buckets.size() >= MAX_PAGE_SOURCES)
+			return false;
+
+		CPageBucket bucket;
+		bucket.m_tokens = m_burst * 1000ULL;
+		bucket.m_time   = now;
+
+		it = m_buckets.insert(std::make_pair(source, bucket)).first;
+	}
+
+	// The tokens are in thousandths of a page
+	CPageBucket& bucket = it->second;
+	bucket.m_tokens += (unsigned long long)(now - bucket.m_time) * m_rate;
+	if (bucket.m_tokens > m_burst * 1000ULL)
+		bucket.m_tokens = m_burst * 1000ULL;
+	bucket.m_time = now;
+
+	if (bucket.m_tokens < 1000ULL)
+		return false;
+
+	bucket.m_tokens -= 1000ULL;
+
+	return true;
+}
+
+unsigned long long CPageInjector::getAccepted() const
+{
+	return m_accepted.load(std::memory_order_relaxed);
+}
+
+unsigned long long CPageInjector::getInvalid() const
+{
+	return m_invalid.load(std::memory_order_relaxed);
+}
+
+unsigned long long CPageInjector::getOverQuota() const
+{
+	return m_overQuota.load(std::memory_order_relaxed);
+}
+
+unsigned long long CPageInjector::getQueueFull() const
+{
+	return m_queueFull.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,87 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(PAGEINJECTOR_H)
+#define	PAGEINJECTOR_H
+
+#include "POCSAGMessage.h"
+#include "StopWatch.h"
+
+#include <unordered_map>
+#include <string>
+#include <deque>
+#include <mutex>
+#include <atomic>
+
+const unsigned int  MAX_RIC            = 0x1FFFFFU;
+const unsigned int  MAX_PAGE_LENGTH    = 240U;
+const unsigned int  MAX_PAGE_SOURCES   = 1000U;
+const unsigned char PAGE_BINARY_FORMAT = 0x01U;
+
+enum class PAGE_RESULT {
+	ACCEPTED,
+	INVALID,
+	OVER_QUOTA,
+	QUEUE_FULL
+};
+
+// Page requests from local systems, they arrive on the MQTT thread and are
+// read by the main loop. A request is either a JSON object:
+//   {"ric": 1234, "functional": 3, "type": 6, "message": "text", "source": "alarm"}
+// or the compact binary form:
+//   0x01, RIC (3 bytes, big endian), functional, type, source length, source, message
+// The message may only be left out, or empty, for a tone only page, functional 1.
+class CPageInjector {
+public:
+	CPageInjector(unsigned int rate, unsigned int burst, unsigned int queue);
+	~CPageInjector();
+
+	PAGE_RESULT write(const unsigned char* data, unsigned int length);
+
+	CPOCSAGMessage* read();
+
+	unsigned long long getAccepted() const;
+	unsigned long long getInvalid() const;
+	unsigned long long getOverQuota() const;
+	unsigned long long getQueueFull() const;
+
+private:
+	struct CPageBucket {
+		unsigned long long m_tokens;
+		unsigned int       m_time;
+	};
+
+	unsigned int                 m_rate;
+	unsigned int                 m_burst;
+	unsigned int                 m_queueSize;
+	std::deque<CPOCSAGMessage*>  m_queue;
+	std::unordered_map<std::string, CPageBucket> m_buckets;
+	CStopWatch                   m_stopWatch;
+	std::mutex                   m_mutex;
+	std::atomic<unsigned long long> m_accepted;
+	std::atomic<unsigned long long> m_invalid;
+	std::atomic<unsigned long long> m_overQuota;
+	std::atomic<unsigned long long> m_queueFull;
+
+	CPOCSAGMessage* parseJSON(const unsigned char* data, unsigned int length, std::string& source) const;
+	CPOCSAGMessage* parseBinary(const unsigned char* data, unsigned int length, std::string& source) const;
+	CPOCSAGMessage* create(unsigned int ric, unsigned int functional, unsigned int type, const std::string& message) const;
+	bool            checkQuota(const std::string& source);
+};
+
+#endif
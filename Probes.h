@@ -0,0 +1,60 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(PROBES_H)
+#define	PROBES_H
+
+// USDT probes for tracing with bpftrace or perf, for example
+//   bpftrace -e 'usdt:/usr/local/bin/DAPNETGateway:dapnetgateway:send_decision { printf("%u %u\n", arg0, arg3); }'
+// A probe is a single nop until a tracer attaches to it. They are compiled in
+// when sys/sdt.h, from the systemtap-sdt-dev package, is found by the Makefile.
+//
+//   message_parsed   id, ric, type, functional, length
+//   filter_verdict   id, ric, reason (an EVENT_REASON, NONE when the message passed)
+//   message_queued   id, ric, queue depth
+//   send_decision    id, codewords, codewords left in the slot, decision (a PROBE_DECISION, NOT_SENT is a
+//                    stale time message or a network error)
+//   pocsag_write     ric, functional, length
+//   mmdvm_free       slot
+//   mmdvm_busy       slot
+//   slot_start       slot, scheduled
+
+enum class PROBE_DECISION : unsigned int {
+	SENT,
+	NO_ROOM,
+	NO_TIME,
+	NOT_SENT
+};
+
+#if defined(HAVE_SYS_SDT_H)
+#include <sys/sdt.h>
+
+#define	PROBE1(name, a1)			DTRACE_PROBE1(dapnetgateway, name, a1)
+#define	PROBE2(name, a1, a2)			DTRACE_PROBE2(dapnetgateway, name, a1, a2)
+#define	PROBE3(name, a1, a2, a3)		DTRACE_PROBE3(dapnetgateway, name, a1, a2, a3)
+#define	PROBE4(name, a1, a2, a3, a4)		DTRACE_PROBE4(dapnetgateway, name, a1, a2, a3, a4)
+#define	PROBE5(name, a1, a2, a3, a4, a5)	DTRACE_PROBE5(dapnetgateway, name, a1, a2, a3, a4, a5)
+#else
+#define	PROBE1(name, a1)			do { } while (0)
+#define	PROBE2(name, a1, a2)			do { } while (0)
+#define	PROBE3(name, a1, a2, a3)		do { } while (0)
+#define	PROBE4(name, a1, a2, a3, a4)		do { } while (0)
+#define	PROBE5(name, a1, a2, a3, a4, a5)	do { } while (0)
+#endif
+
+#endif
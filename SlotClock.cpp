@@ -0,0 +1,122 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "SlotClock.h"
+#include "Clock.h"
+#include "Log.h"
+
+#include <cassert>
+#include <cstdlib>
+
+const unsigned long long NS_PER_MS = 1000000ULL;
+
+const unsigned long long SLOT_LENGTH_NS = SLOT_CLOCK_LENGTH * NS_PER_MS;
+
+// The largest error that is slewed out, and the rate of the slew
+const long long MAX_SLEW_NS   = 1000LL * 1000000LL;
+const long long MAX_SLEW_PPM  = 1000LL;
+
+CSlotClock::CSlotClock() :
+m_offset(0LL),
+m_target(0LL),
+m_last(0ULL)
+{
+	m_last   = monotonic();
+	m_offset = (long long)(wall() - m_last);
+}
+
+CSlotClock::~CSlotClock()
+{
+}
+
+void CSlotClock::clock()
+{
+	unsigned long long now = monotonic();
+	long long target = (long long)(wall() - now) + m_target;
+
+	long long error = target - m_offset;
+
+	if (::llabs(error) > MAX_SLEW_NS) {
+		LogMessage("Stepping the slot clock by %lld ms", error / (long long)NS_PER_MS);
+		m_offset = target;
+	} else {
+		long long slew = ((long long)(now - m_last) * MAX_SLEW_PPM) / 1000000LL;
+
+		if (error > slew)
+			m_offset += slew;
+		else if (error < -slew)
+			m_offset -= slew;
+		else
+			m_offset = target;
+	}
+
+	m_last = now;
+}
+
+void CSlotClock::setOffset(int offset)
+{
+	m_target = (long long)offset * (long long)NS_PER_MS;
+}
+
+unsigned long long CSlotClock::time() const
+{
+	return slotTime(monotonic()) / NS_PER_MS;
+}
+
+unsigned int CSlotClock::getSlot() const
+{
+	return (unsigned int)((slotTime(monotonic()) / SLOT_LENGTH_NS) % SLOT_CLOCK_SLOTS);
+}
+
+unsigned int CSlotClock::elapsed() const
+{
+	return (unsigned int)((slotTime(monotonic()) % SLOT_LENGTH_NS) / NS_PER_MS);
+}
+
+unsigned int CSlotClock::lateness() const
+{
+	return (unsigned int)((slotTime(monotonic()) % SLOT_LENGTH_NS) / 1000ULL);
+}
+
+unsigned long long CSlotClock::slotTime(unsigned long long monotonic) const
+{
+	return (unsigned long long)((long long)monotonic + m_offset);
+}
+
+void CSlotClock::sleep(unsigned int ms) const
+{
+	unsigned long long now = monotonic();
+
+	// The monotonic time of the next boundary
+	unsigned long long boundary = now + (SLOT_LENGTH_NS - (slotTime(now) % SLOT_LENGTH_NS));
+	unsigned long long deadline = now + ms * NS_PER_MS;
+	if (boundary < deadline)
+		deadline = boundary;
+
+	CClock::get().sleepUntil(deadline);
+}
+
+unsigned long long CSlotClock::monotonic()
+{
+	return CClock::get().monotonic();
+}
+
+unsigned long long CSlotClock::wall()
+{
+	return CClock::get().wall();
+}
@@ -0,0 +1,64 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(SLOTCLOCK_H)
+#define	SLOTCLOCK_H
+
+const unsigned int SLOT_CLOCK_SLOTS  = 16U;
+const unsigned int SLOT_CLOCK_LENGTH = 6400U;		// In ms
+
+// The time used for the DAPNET slots. It runs on the monotonic clock so it
+// never jumps, and is slewed towards the wall clock, plus any offset from the
+// DAPNET core, by no more than 1 ms a second. Only errors of over a second,
+// such as the clock being set at boot, are stepped. Slot boundaries fall on
+// multiples of 6.4 s of this time, and can be waited for exactly.
+class CSlotClock {
+public:
+	CSlotClock();
+	~CSlotClock();
+
+	// Follow the wall clock, called on each pass through the main loop
+	void clock();
+
+	// In ms, added to the wall clock
+	void setOffset(int offset);
+
+	// In ms
+	unsigned long long time() const;
+
+	unsigned int getSlot() const;
+
+	// The time since the start of the current slot, in ms and us
+	unsigned int elapsed() const;
+	unsigned int lateness() const;
+
+	// Sleep for up to ms, but wake at the next slot boundary if it comes first
+	void sleep(unsigned int ms) const;
+
+private:
+	long long          m_offset;			// In ns, from the monotonic clock to the slot time
+	long long          m_target;			// In ns, the offset from the monotonic clock to the wall clock
+	unsigned long long m_last;			// In ns, the monotonic time of the last clock()
+
+	unsigned long long slotTime(unsigned long long monotonic) const;
+
+	static unsigned long long monotonic();
+	static unsigned long long wall();
+};
+
+#endif
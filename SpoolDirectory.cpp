@@ -0,0 +1,277 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "SpoolDirectory.h"
+#include "PageInjector.h"
+#include "Log.h"
+
+#include <algorithm>
+#include <vector>
+
+#include <cassert>
+#include <cstring>
+#include <cstdlib>
+#include <cctype>
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+CSpoolDirectory::CSpoolDirectory(const std::string& directory) :
+m_directory(directory),
+m_fd(-1),
+m_files(),
+m_file(nullptr),
+m_fileName(),
+m_pages(0U),
+m_invalid(0U)
+{
+	assert(!directory.empty());
+}
+
+CSpoolDirectory::~CSpoolDirectory()
+{
+}
+
+bool CSpoolDirectory::open()
+{
+#if defined(_WIN32) || defined(_WIN64)
+	LogWarning("The spool directory is not supported on Windows");
+	return false;
+#else
+	std::string done   = m_directory + "/done";
+	std::string failed = m_directory + "/failed";
+	::mkdir(done.c_str(), 0755);
+	::mkdir(failed.c_str(), 0755);
+
+	m_fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (m_fd == -1) {
+		LogError("Cannot initialise inotify, err=%d", errno);
+		return false;
+	}
+
+	if (::inotify_add_watch(m_fd, m_directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) == -1) {
+		LogError("Cannot watch the spool directory %s, err=%d", m_directory.c_str(), errno);
+		::close(m_fd);
+		m_fd = -1;
+		return false;
+	}
+
+	// Pick up anything that arrived while we weren't running
+	scan();
+
+	LogMessage("Watching the spool directory %s", m_directory.c_str());
+
+	return true;
+#endif
+}
+
+CPOCSAGMessage* CSpoolDirectory::read()
+{
+	for (;;) {
+		if (m_file == nullptr && !next())
+			return nullptr;
+
+		char line[SPOOL_LINE_LENGTH];
+		if (::fgets(line, SPOOL_LINE_LENGTH, m_file) == nullptr) {
+			if (::ferror(m_file) != 0) {
+				LogError("Error reading the spool file %s", m_fileName.c_str());
+				finish("failed");
+			} else {
+				LogMessage("Read %u pages from the spool file %s, %u lines were invalid", m_pages, m_fileName.c_str(), m_invalid);
+				finish("done");
+			}
+			continue;
+		}
+
+		// Skip the rest of an over long line
+		if (::strchr(line, '\n') == nullptr && !::feof(m_file)) {
+			int c;
+			while ((c = ::fgetc(m_file)) != EOF && c != '\n')
+				;
+			m_invalid++;
+			continue;
+		}
+
+		if (line[0U] == '#' || line[0U] == '\r' || line[0U] == '\n')
+			continue;
+
+		CPOCSAGMessage* message = parse(line);
+		if (message == nullptr) {
+			m_invalid++;
+			continue;
+		}
+
+		m_pages++;
+
+		return message;
+	}
+}
+
+void CSpoolDirectory::close()
+{
+	if (m_file != nullptr) {
+		::fclose(m_file);
+		m_file = nullptr;
+	}
+
+#if !defined(_WIN32) && !defined(_WIN64)
+	if (m_fd != -1) {
+		::close(m_fd);
+		m_fd = -1;
+	}
+#endif
+}
+
+void CSpoolDirectory::scan()
+{
+#if !defined(_WIN32) && !defined(_WIN64)
+	DIR* dir = ::opendir(m_directory.c_str());
+	if (dir == nullptr)
+		return;
+
+	std::vector<std::string> files;
+
+	struct dirent* entry;
+	while ((entry = ::readdir(dir)) != nullptr) {
+		if (entry->d_name[0U] == '.')
+			continue;
+
+		std::string path = m_directory + "/" + entry->d_name;
+
+		struct stat st;
+		if (::stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode))
+			files.push_back(entry->d_name);
+	}
+
+	::closedir(dir);
+
+	// Assume that the names sort into the order they were written
+	std::sort(files.begin(), files.end());
+	m_files.insert(m_files.end(), files.begin(), files.end());
+#endif
+}
+
+void CSpoolDirectory::watch()
+{
+#if !defined(_WIN32) && !defined(_WIN64)
+	if (m_fd == -1)
+		return;
+
+	alignas(struct inotify_event) char buffer[4096U];
+
+	bool overflow = false;
+
+	for (;;) {
+		ssize_t len = ::read(m_fd, buffer, sizeof(buffer));
+		if (len <= 0)
+			break;
+
+		for (char* p = buffer; p < (buffer + len); ) {
+			const struct inotify_event* event = (const struct inotify_event*)p;
+
+			if ((event->mask & IN_Q_OVERFLOW) != 0U)
+				overflow = true;
+			else if (event->len > 0U && event->name[0U] != '.' && (event->mask & IN_ISDIR) == 0U)
+				m_files.push_back(event->name);
+
+			p += sizeof(struct inotify_event) + event->len;
+		}
+	}
+
+	// Some files were missed, start again from what is in the directory
+	if (overflow) {
+		LogWarning("Too many files arrived in the spool directory at once, rescanning it");
+		m_files.clear();
+		scan();
+	}
+#endif
+}
+
+bool CSpoolDirectory::next()
+{
+	if (m_files.empty())
+		watch();
+
+	while (!m_files.empty()) {
+		m_fileName = m_files.front();
+		m_files.pop_front();
+
+		std::string path = m_directory + "/" + m_fileName;
+
+		m_file = ::fopen(path.c_str(), "rt");
+		if (m_file != nullptr) {
+			m_pages   = 0U;
+			m_invalid = 0U;
+			return true;
+		}
+
+		// It may have been seen by both the scan and inotify
+		if (errno != ENOENT) {
+			LogError("Cannot open the spool file %s, err=%d", path.c_str(), errno);
+			finish("failed");
+		}
+	}
+
+	return false;
+}
+
+void CSpoolDirectory::finish(const char* subDirectory)
+{
+	assert(subDirectory != nullptr);
+
+	if (m_file != nullptr) {
+		::fclose(m_file);
+		m_file = nullptr;
+	}
+
+	std::string from = m_directory + "/" + m_fileName;
+	std::string to   = m_directory + "/" + subDirectory + "/" + m_fileName;
+
+	if (::rename(from.c_str(), to.c_str()) != 0)
+		LogError("Cannot move the spool file %s to %s, err=%d", from.c_str(), to.c_str(), errno);
+}
+
+CPOCSAGMessage* CSpoolDirectory::parse(char* line) const
+{
+	assert(line != nullptr);
+
+	char* p1 = ::strtok(line, ":\r\n");
+	char* p2 = ::strtok(nullptr, ":\r\n");
+	char* p3 = ::strtok(nullptr, ":\r\n");
+	char* p4 = ::strtok(nullptr, ":\r\n");
+	char* p5 = ::strtok(nullptr, "\r\n");
+
+	if (p1 == nullptr || p2 == nullptr || p3 == nullptr || p4 == nullptr || p5 == nullptr)
+		return nullptr;
+
+	unsigned int type = ::strtoul(p1, nullptr, 10);
+	unsigned int addr = ::strtoul(p3, nullptr, 16);
+	unsigned int func = ::strtoul(p4, nullptr, 10);
+
+	unsigned int length = (unsigned int)::strlen(p5);
+
+	if (type > 0xFFU || addr > MAX_RIC || func > 3U || length > MAX_PAGE_LENGTH)
+		return nullptr;
+
+	return new CPOCSAGMessage(type, addr, func, (unsigned char*)p5, length);
+}
@@ -0,0 +1,62 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(SPOOLDIRECTORY_H)
+#define	SPOOLDIRECTORY_H
+
+#include "POCSAGMessage.h"
+
+#include <string>
+#include <deque>
+#include <cstdio>
+
+const unsigned int SPOOL_LINE_LENGTH = 300U;
+
+// Watches a directory for files of page requests, one per line in the same
+// form as the body of a DAPNET message, type:speed:address:functional:text
+// with the address in hex. Files whose names start with a '.' are ignored so
+// that they can be written in place and then renamed. Once read a file is
+// moved into the done sub-directory, or failed if it couldn't be read.
+class CSpoolDirectory {
+public:
+	CSpoolDirectory(const std::string& directory);
+	~CSpoolDirectory();
+
+	bool open();
+
+	CPOCSAGMessage* read();
+
+	void close();
+
+private:
+	std::string             m_directory;
+	int                     m_fd;
+	std::deque<std::string> m_files;
+	FILE*                   m_file;
+	std::string             m_fileName;
+	unsigned int            m_pages;
+	unsigned int            m_invalid;
+
+	void scan();
+	void watch();
+	bool next();
+	void finish(const char* subDirectory);
+	CPOCSAGMessage* parse(char* line) const;
+};
+
+#endif
@@ -0,0 +1,126 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "StageProfiler.h"
+#include "Utils.h"
+
+#include <chrono>
+#include <thread>
+
+#include <cassert>
+#include <cstring>
+
+CStageProfiler::CStageProfiler() :
+m_enabled(false),
+m_scale(0U),
+m_start(0U),
+m_last(0U),
+m_id(0U),
+m_histograms(),
+m_outliers()
+{
+	reset();
+}
+
+CStageProfiler::~CStageProfiler()
+{
+}
+
+void CStageProfiler::setEnabled(bool enabled)
+{
+	if (enabled && m_scale == 0U)
+		calibrate();
+
+	// Enabling part way through a pass mustn't record the time since the last one
+	m_start = m_last = ticks();
+	m_id    = 0U;
+
+	m_enabled = enabled;
+}
+
+bool CStageProfiler::isEnabled() const
+{
+	return m_enabled;
+}
+
+void CStageProfiler::write(nlohmann::json& json) const
+{
+	for (unsigned int i = 0U; i < PROFILE_STAGES; i++) {
+		nlohmann::json stage;
+		m_histograms[i].write(stage["histogram"]);
+
+		nlohmann::json outliers = nlohmann::json::array();
+		for (unsigned int j = 0U; j < PROFILE_OUTLIERS; j++) {
+			const COutlier& outlier = m_outliers[i][j];
+			if (outlier.m_time == 0U)
+				break;
+
+			nlohmann::json entry;
+			entry["time"] = outlier.m_time;
+			entry["id"]   = outlier.m_id;
+			entry["when"] = outlier.m_when;
+			outliers.push_back(entry);
+		}
+
+		stage["outliers"] = outliers;
+
+		json[::StageName(STAGE(i))] = stage;
+	}
+}
+
+void CStageProfiler::reset()
+{
+	for (unsigned int i = 0U; i < PROFILE_STAGES; i++)
+		m_histograms[i].reset();
+
+	::memset(m_outliers, 0x00U, sizeof(m_outliers));
+}
+
+void CStageProfiler::outlier(unsigned int stage, unsigned int us)
+{
+	COutlier* outliers = m_outliers[stage];
+
+	// Keep them in descending order, the last one is always the smallest
+	unsigned int i = PROFILE_OUTLIERS - 1U;
+	while (i > 0U && us > outliers[i - 1U].m_time) {
+		outliers[i] = outliers[i - 1U];
+		i--;
+	}
+
+	outliers[i].m_time = us;
+	outliers[i].m_id   = m_id;
+	::strncpy(outliers[i].m_when, CUtils::createTimestamp().c_str(), sizeof(outliers[i].m_when) - 1U);
+}
+
+void CStageProfiler::calibrate()
+{
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	uint64_t ticks1 = ticks();
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+	uint64_t ticks2 = ticks();
+	uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+	assert(ticks2 > ticks1);
+
+	// 2^32 * 1000 * microseconds, divided by nanoseconds
+	m_scale = ((ns << 32) / 1000U) / (ticks2 - ticks1);
+	if (m_scale == 0U)
+		m_scale = 1U;
+}
@@ -0,0 +1,148 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(STAGEPROFILER_H)
+#define	STAGEPROFILER_H
+
+#include "Histogram.h"
+
+#include <nlohmann/json.hpp>
+
+#include <cstdint>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <chrono>
+#endif
+
+enum class STAGE : unsigned int {
+	MMDVM_READ,
+	DAPNET_READ,
+	ADMIT,
+	SLOT,
+	SEND,
+	HOUSEKEEPING,
+	LOOP,
+	// Only used by the watchdog
+	RECONNECT,
+	SLEEP
+};
+
+const unsigned int PROFILE_STAGES   = (unsigned int)STAGE::LOOP + 1U;
+const unsigned int PROFILE_OUTLIERS = 4U;
+
+inline const char* StageName(STAGE stage)
+{
+	static const char* NAMES[] = {"mmdvm_read", "dapnet_read", "admit", "slot", "send", "housekeeping", "loop", "reconnect", "sleep"};
+
+	return stage <= STAGE::SLEEP ? NAMES[(unsigned int)stage] : "unknown";
+}
+
+// Times each stage of the main loop with the cycle counter, where there is
+// one, in microsecond histograms. The worst few times of each stage are kept
+// with the last message that the stage handled. When disabled the cost is a
+// test of a flag at each stage.
+class CStageProfiler {
+public:
+	CStageProfiler();
+	~CStageProfiler();
+
+	void setEnabled(bool enabled);
+	bool isEnabled() const;
+
+	// The start of a pass through the main loop
+	void start()
+	{
+		if (!m_enabled)
+			return;
+
+		m_start = m_last = ticks();
+	}
+
+	// The message being handled by the current stage
+	void setMessage(unsigned int id)
+	{
+		m_id = id;
+	}
+
+	// The end of a stage, HOUSEKEEPING is the last one and also ends the loop
+	void mark(STAGE stage)
+	{
+		if (!m_enabled)
+			return;
+
+		uint64_t now = ticks();
+
+		record((unsigned int)stage, now - m_last);
+		if (stage == STAGE::HOUSEKEEPING)
+			record((unsigned int)STAGE::LOOP, now - m_start);
+
+		m_last = now;
+		m_id   = 0U;
+	}
+
+	void write(nlohmann::json& json) const;
+
+	void reset();
+
+private:
+	struct COutlier {
+		unsigned int       m_time;
+		unsigned int       m_id;
+		char               m_when[30U];
+	};
+
+	bool         m_enabled;
+	uint64_t     m_scale;		// Microseconds per tick in 32.32 fixed point
+	uint64_t     m_start;
+	uint64_t     m_last;
+	unsigned int m_id;
+	CHistogram   m_histograms[PROFILE_STAGES];
+	COutlier     m_outliers[PROFILE_STAGES][PROFILE_OUTLIERS];
+
+	static uint64_t ticks()
+	{
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+		return __rdtsc();
+#else
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+	}
+
+	void record(unsigned int stage, uint64_t ticks)
+	{
+		// Clamp very long stalls, such as a reconnect, so that the conversion can't overflow
+		if (ticks > 0xFFFFFFFFFFULL)
+			ticks = 0xFFFFFFFFFFULL;
+
+		unsigned int us = (unsigned int)((ticks * m_scale) >> 32);
+
+		m_histograms[stage].add(us);
+
+		if (us > m_outliers[stage][PROFILE_OUTLIERS - 1U].m_time)
+			outlier(stage, us);
+	}
+
+	void outlier(unsigned int stage, unsigned int us);
+	void calibrate();
+};
+
+#endif
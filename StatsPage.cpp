@@ -0,0 +1,140 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "StatsPage.h"
+#include "StopWatch.h"
+#include "Log.h"
+
+#include <cassert>
+#include <cstring>
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+CStatsPage::CStatsPage(const std::string& name) :
+m_name(name),
+m_page(nullptr),
+m_stopWatch(),
+m_loopTimeMax(0U)
+{
+	assert(!name.empty());
+}
+
+CStatsPage::~CStatsPage()
+{
+}
+
+bool CStatsPage::open()
+{
+#if defined(_WIN32) || defined(_WIN64)
+	LogWarning("The statistics page is not supported on Windows");
+	return false;
+#else
+	// Start with a new, zeroed, object so that a reader of an old one isn't confused
+	::shm_unlink(m_name.c_str());
+
+	int fd = ::shm_open(m_name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+	if (fd == -1) {
+		LogError("Cannot open the statistics page %s, err=%d", m_name.c_str(), errno);
+		return false;
+	}
+
+	if (::ftruncate(fd, sizeof(CStatsPageData)) == -1) {
+		LogError("Cannot size the statistics page %s, err=%d", m_name.c_str(), errno);
+		::close(fd);
+		::shm_unlink(m_name.c_str());
+		return false;
+	}
+
+	void* addr = ::mmap(nullptr, sizeof(CStatsPageData), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+
+	if (addr == MAP_FAILED) {
+		LogError("Cannot map the statistics page %s, err=%d", m_name.c_str(), errno);
+		::shm_unlink(m_name.c_str());
+		return false;
+	}
+
+	m_page = (CStatsPageData*)addr;
+	m_page->m_magic   = STATS_PAGE_MAGIC;
+	m_page->m_version = STATS_PAGE_VERSION;
+	m_page->m_size    = sizeof(CStatsPageData);
+	m_page->m_pid     = (uint32_t)::getpid();
+	m_page->m_start   = m_stopWatch.time();
+	m_page->m_time    = m_page->m_start;
+
+	m_page->m_sequence.store(2U, std::memory_order_release);
+
+	LogMessage("Publishing statistics in the shared memory page %s", m_name.c_str());
+
+	return true;
+#endif
+}
+
+void CStatsPage::update(const CMetrics& metrics)
+{
+	if (m_page == nullptr)
+		return;
+
+	// The maximum loop time in the metrics is reset by each scrape, so keep our own
+	uint32_t loopTime = metrics.m_loopTime.load(std::memory_order_relaxed);
+	if (loopTime > m_loopTimeMax)
+		m_loopTimeMax = loopTime;
+
+	uint32_t sequence = m_page->m_sequence.load(std::memory_order_relaxed);
+	m_page->m_sequence.store(sequence + 1U, std::memory_order_relaxed);
+
+	std::atomic_thread_fence(std::memory_order_release);
+
+	m_page->m_time            = m_stopWatch.time();
+	m_page->m_received        = metrics.m_received.load(std::memory_order_relaxed);
+	m_page->m_filtered        = metrics.m_filtered.load(std::memory_order_relaxed);
+	m_page->m_queued          = metrics.m_queued.load(std::memory_order_relaxed);
+	m_page->m_sent            = metrics.m_sent.load(std::memory_order_relaxed);
+	m_page->m_rejected        = metrics.m_rejected.load(std::memory_order_relaxed);
+	m_page->m_deferred        = metrics.m_deferred.load(std::memory_order_relaxed);
+	m_page->m_codewordsSent   = metrics.m_codewordsSent.load(std::memory_order_relaxed);
+	m_page->m_codewordsBudget = metrics.m_codewordsBudget.load(std::memory_order_relaxed);
+	m_page->m_reconnects      = metrics.m_reconnects.load(std::memory_order_relaxed);
+	m_page->m_loops           = metrics.m_loops.load(std::memory_order_relaxed);
+	m_page->m_queueDepth      = metrics.m_queueDepth.load(std::memory_order_relaxed);
+	m_page->m_currentSlot     = metrics.m_currentSlot.load(std::memory_order_relaxed);
+	m_page->m_mmdvmFree       = metrics.m_mmdvmFree.load(std::memory_order_relaxed) ? 1U : 0U;
+	m_page->m_loopTime        = loopTime;
+	m_page->m_loopTimeTotal   = metrics.m_loopTimeTotal.load(std::memory_order_relaxed);
+	m_page->m_loopTimeMax     = m_loopTimeMax;
+	m_page->m_mqttBuffered    = metrics.m_mqttBuffered.load(std::memory_order_relaxed);
+
+	m_page->m_sequence.store(sequence + 2U, std::memory_order_release);
+}
+
+void CStatsPage::close()
+{
+#if !defined(_WIN32) && !defined(_WIN64)
+	if (m_page != nullptr) {
+		::munmap(m_page, sizeof(CStatsPageData));
+		::shm_unlink(m_name.c_str());
+		m_page = nullptr;
+	}
+#endif
+}
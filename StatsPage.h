@@ -0,0 +1,108 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(STATSPAGE_H)
+#define	STATSPAGE_H
+
+#include "StopWatch.h"
+#include "Metrics.h"
+
+#include <atomic>
+#include <string>
+#include <cstdint>
+#include <cstring>
+#include <cassert>
+
+const uint32_t STATS_PAGE_MAGIC   = 0x44415053U;	// "DAPS"
+const uint32_t STATS_PAGE_VERSION = 1U;
+
+// The layout of the shared memory page, it is read by dapnetstat. Fields are
+// only ever added to the end, and the version is changed if any are changed.
+// The sequence is odd while the gateway is writing, a reader copies the page
+// and retries if the sequence was odd or changed during the copy.
+struct CStatsPageData {
+	uint32_t              m_magic;
+	uint32_t              m_version;
+	uint32_t              m_size;
+	uint32_t              m_pid;
+	std::atomic<uint32_t> m_sequence;
+	uint32_t              m_reserved;
+	uint64_t              m_start;		// Wall clock milliseconds when the gateway started
+	uint64_t              m_time;		// Wall clock milliseconds of the last update
+	uint64_t              m_received;
+	uint64_t              m_filtered;
+	uint64_t              m_queued;
+	uint64_t              m_sent;
+	uint64_t              m_rejected;
+	uint64_t              m_deferred;
+	uint64_t              m_codewordsSent;
+	uint64_t              m_codewordsBudget;
+	uint64_t              m_reconnects;
+	uint64_t              m_loops;
+	uint64_t              m_loopTimeTotal;	// Milliseconds, excluding the sleep
+	uint32_t              m_queueDepth;
+	uint32_t              m_currentSlot;
+	uint32_t              m_mmdvmFree;
+	uint32_t              m_loopTime;
+	uint32_t              m_loopTimeMax;	// Since the gateway started
+	uint32_t              m_mqttBuffered;
+};
+
+// Reads the page into data, returns false if it isn't valid or is always being written
+inline bool StatsPageRead(const CStatsPageData* page, CStatsPageData& data)
+{
+	assert(page != nullptr);
+
+	for (unsigned int i = 0U; i < 1000U; i++) {
+		uint32_t sequence1 = page->m_sequence.load(std::memory_order_acquire);
+		if ((sequence1 & 1U) == 1U)
+			continue;
+
+		::memcpy((void*)&data, (const void*)page, sizeof(CStatsPageData));
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		uint32_t sequence2 = page->m_sequence.load(std::memory_order_relaxed);
+		if (sequence1 == sequence2)
+			return data.m_magic == STATS_PAGE_MAGIC && data.m_version == STATS_PAGE_VERSION;
+	}
+
+	return false;
+}
+
+// Publishes the gateway's metrics in a POSIX shared memory object, so that
+// they can be watched without any system calls in the gateway.
+class CStatsPage {
+public:
+	CStatsPage(const std::string& name);
+	~CStatsPage();
+
+	bool open();
+
+	void update(const CMetrics& metrics);
+
+	void close();
+
+private:
+	std::string     m_name;
+	CStatsPageData* m_page;
+	CStopWatch      m_stopWatch;
+	uint32_t        m_loopTimeMax;
+};
+
+#endif
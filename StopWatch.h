@@ -1,5 +1,5 @@
 /*
- *   Copyright (C) 2015,2016,2018 by Jonathan Naylor G4KLX
+ *   Copyright (C) 2015,2016,2018,2026 by Jonathan Naylor G4KLX
  *
  *   This program is free software; you can redistribute it and/or modify
  *   it under the terms of the GNU General Public License as published by
@@ -19,14 +19,8 @@
 #if !defined(STOPWATCH_H)
 #define	STOPWATCH_H
 
-#if defined(_WIN32) || defined(_WIN64)
-#define _WINSOCKAPI_
-#include <WS2tcpip.h>
-#include <windows.h>
-#else
-#include <sys/time.h>
-#endif
-
+// Times from the current CClock, wall time in ms from time() and monotonic
+// ms from start() and elapsed()
 class CStopWatch
 {
 public:
@@ -36,16 +30,10 @@ public:
 	unsigned long long time() const;
 
 	unsigned long long start();
-	unsigned int       elapsed();
+	unsigned int       elapsed() const;
 
 private:
-#if defined(_WIN32) || defined(_WIN64)
-	LARGE_INTEGER  m_frequencyS;
-	LARGE_INTEGER  m_frequencyMS;
-	LARGE_INTEGER  m_start;
-#else
 	unsigned long long m_startMS;
-#endif
 };
 
 #endif
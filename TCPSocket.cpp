@@ -1,5 +1,5 @@
 /*
- *   Copyright (C) 2010-2013,2016,2018,2025 by Jonathan Naylor G4KLX
+ *   Copyright (C) 2010-2013,2016,2018,2025,2026 by Jonathan Naylor G4KLX
  *
  *   This program is free software; you can redistribute it and/or modify
  *   it under the terms of the GNU General Public License as published by
@@ -88,9 +88,9 @@ bool CTCPSocket::open()
 
 	if (::connect(m_fd, (sockaddr*)&addr, addrlen) == -1) {
 #if defined(_WIN32) || defined(_WIN64)
-		LogError("Cannot connect the TCP client socket, err=%d", ::GetLastError());
+		LogErrorLimited("Cannot connect the TCP client socket, err=%d", ::GetLastError());
 #else
-		LogError("Cannot connect the TCP client socket, err=%d", errno);
+		LogErrorLimited("Cannot connect the TCP client socket, err=%d", errno);
 #endif
 		close();
 		return false;
@@ -148,9 +148,9 @@ int CTCPSocket::read(unsigned char* buffer, unsigned int length, unsigned int se
 	int ret = ::select(int(m_fd) + 1, &readFds, nullptr, nullptr, &tv);
 	if (ret < 0) {
 #if defined(_WIN32) || defined(_WIN64)
-		LogError("Error returned from TCP client select, err=%d", ::GetLastError());
+		LogErrorLimited("Error returned from TCP client select, err=%d", ::GetLastError());
 #else
-		LogError("Error returned from TCP client select, err=%d", errno);
+		LogErrorLimited("Error returned from TCP client select, err=%d", errno);
 #endif
 		return -1;
 	}
@@ -168,9 +168,9 @@ int CTCPSocket::read(unsigned char* buffer, unsigned int length, unsigned int se
 		return -2;
 	} else if (len < 0) {
 #if defined(_WIN32) || defined(_WIN64)
-		LogError("Error returned from recv, err=%d", ::GetLastError());
+		LogErrorLimited("Error returned from recv, err=%d", ::GetLastError());
 #else
-		LogError("Error returned from recv, err=%d", errno);
+		LogErrorLimited("Error returned from recv, err=%d", errno);
 #endif
 		return -1;
 	}
@@ -215,9 +215,9 @@ bool CTCPSocket::write(const unsigned char* buffer, unsigned int length)
 	ssize_t ret = ::send(m_fd, (char *)buffer, length, 0);
 	if (ret != ssize_t(length)) {
 #if defined(_WIN32) || defined(_WIN64)
-		LogError("Error returned from send, err=%d", ::GetLastError());
+		LogErrorLimited("Error returned from send, err=%d", ::GetLastError());
 #else
-		LogError("Error returned from send, err=%d", errno);
+		LogErrorLimited("Error returned from send, err=%d", errno);
 #endif
 		return false;
 	}
@@ -242,6 +242,34 @@ bool CTCPSocket::writeLine(const std::string& line)
 	return result;
 }
 
+bool CTCPSocket::getHealth(CTCPHealth& health) const
+{
+#if defined(__linux__)
+	if (m_fd == -1)
+		return false;
+
+	struct tcp_info info;
+	socklen_t length = sizeof(info);
+	if (::getsockopt(m_fd, IPPROTO_TCP, TCP_INFO, &info, &length) == -1) {
+		LogError("Cannot read TCP_INFO from the TCP client socket, err=%d", errno);
+		return false;
+	}
+
+	health.m_rtt              = info.tcpi_rtt;
+	health.m_rttVar           = info.tcpi_rttvar;
+	health.m_retransmits      = info.tcpi_retransmits;
+	health.m_totalRetransmits = info.tcpi_total_retrans;
+	health.m_unacked          = info.tcpi_unacked;
+	health.m_lost             = info.tcpi_lost;
+	health.m_lastDataReceived = info.tcpi_last_data_recv;
+	health.m_lastAckReceived  = info.tcpi_last_ack_recv;
+
+	return true;
+#else
+	return false;
+#endif
+}
+
 void CTCPSocket::close()
 {
 #if defined(_WIN32) || defined(_WIN64)
@@ -1,5 +1,5 @@
 /*
- *   Copyright (C) 2010,2011,2012,2013,2016,2025 by Jonathan Naylor G4KLX
+ *   Copyright (C) 2010,2011,2012,2013,2016,2025,2026 by Jonathan Naylor G4KLX
  *
  *   This program is free software; you can redistribute it and/or modify
  *   it under the terms of the GNU General Public License as published by
@@ -36,6 +36,18 @@
 
 #include <string>
 
+// From TCP_INFO, times are in microseconds except for the last receive times
+struct CTCPHealth {
+	unsigned int m_rtt;
+	unsigned int m_rttVar;
+	unsigned int m_retransmits;		// Unrecovered retransmissions of the oldest segment
+	unsigned int m_totalRetransmits;	// Over the life of the connection
+	unsigned int m_unacked;
+	unsigned int m_lost;
+	unsigned int m_lastDataReceived;	// Milliseconds ago
+	unsigned int m_lastAckReceived;		// Milliseconds ago
+};
+
 class CTCPSocket {
 public:
 	CTCPSocket(const std::string& address, unsigned int port);
@@ -48,6 +60,9 @@ public:
 	bool write(const unsigned char* buffer, unsigned int length);
 	bool writeLine(const std::string& line);
 
+	// Only available on Linux
+	bool getHealth(CTCPHealth& health) const;
+
 	void close();
 
 private:
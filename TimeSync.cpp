@@ -0,0 +1,161 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "TimeSync.h"
+
+#include <cassert>
+#include <cstdint>
+
+CTimeSync::CTimeSync() :
+m_samples(),
+m_count(0U),
+m_next(0U),
+m_clock(),
+m_rttTimer(),
+m_pending(false),
+m_coreTime(0U),
+m_localTime(0ULL),
+m_timing(false),
+m_lastRTT(0U),
+m_correction(0)
+{
+}
+
+CTimeSync::~CTimeSync()
+{
+}
+
+unsigned int CTimeSync::request(unsigned int coreTime)
+{
+	// The previous exchange didn't get a '3', use the last round trip time that we had
+	if (m_pending)
+		add(m_lastRTT);
+
+	m_localTime = m_clock.time();
+	m_coreTime  = coreTime & 0xFFFFU;
+	m_pending   = true;
+	m_timing    = false;
+
+	return (unsigned int)((m_localTime / 100ULL) & 0xFFFFULL);
+}
+
+void CTimeSync::replied()
+{
+	if (!m_pending)
+		return;
+
+	m_rttTimer.start();
+	m_timing = true;
+}
+
+void CTimeSync::correction(int correction)
+{
+	m_correction = correction;
+
+	if (!m_pending)
+		return;
+
+	unsigned int rtt = m_timing ? m_rttTimer.elapsed() : m_lastRTT;
+	m_lastRTT = rtt;
+
+	add(rtt);
+}
+
+bool CTimeSync::isValid() const
+{
+	return m_count >= TIME_SYNC_MINIMUM;
+}
+
+int CTimeSync::getOffset() const
+{
+	const CTimeSample* sample = best();
+
+	return sample != nullptr ? sample->m_offset : 0;
+}
+
+unsigned int CTimeSync::getRTT() const
+{
+	const CTimeSample* sample = best();
+
+	return sample != nullptr ? sample->m_rtt : 0U;
+}
+
+int CTimeSync::getDrift() const
+{
+	if (m_count < TIME_SYNC_MINIMUM)
+		return 0;
+
+	// A least squares fit of the offsets against time, as any two samples are dominated by the decisecond resolution
+	unsigned long long origin = m_samples[m_count < TIME_SYNC_WINDOW ? 0U : m_next].m_time;
+
+	double sumX = 0.0, sumY = 0.0, sumXX = 0.0, sumXY = 0.0;
+	for (unsigned int i = 0U; i < m_count; i++) {
+		double x = double(m_samples[i].m_time - origin);
+		double y = double(m_samples[i].m_offset);
+
+		sumX  += x;
+		sumY  += y;
+		sumXX += x * x;
+		sumXY += x * y;
+	}
+
+	double n = double(m_count);
+	double denominator = n * sumXX - sumX * sumX;
+	if (denominator <= 0.0)
+		return 0;
+
+	return int(((n * sumXY - sumX * sumY) / denominator) * 1000000.0);
+}
+
+int CTimeSync::getCorrection() const
+{
+	return m_correction;
+}
+
+void CTimeSync::add(unsigned int rtt)
+{
+	m_pending = false;
+	m_timing  = false;
+
+	// The difference in deciseconds, allowing for the wrap at 65536
+	int16_t diff = int16_t(uint16_t(m_coreTime - (unsigned int)((m_localTime / 100ULL) & 0xFFFFULL)));
+
+	// The core's time is truncated to a decisecond, take the middle of it, and it was sent half a round trip ago
+	int offset = int(diff) * 100 + 50 - int(m_localTime % 100ULL) + int(rtt / 2U);
+
+	CTimeSample& sample = m_samples[m_next];
+	sample.m_time   = m_localTime;
+	sample.m_offset = offset;
+	sample.m_rtt    = rtt;
+
+	m_next = (m_next + 1U) % TIME_SYNC_WINDOW;
+	if (m_count < TIME_SYNC_WINDOW)
+		m_count++;
+}
+
+const CTimeSync::CTimeSample* CTimeSync::best() const
+{
+	const CTimeSample* best = nullptr;
+
+	for (unsigned int i = 0U; i < m_count; i++) {
+		if (best == nullptr || m_samples[i].m_rtt < best->m_rtt)
+			best = &m_samples[i];
+	}
+
+	return best;
+}
@@ -0,0 +1,74 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(TIMESYNC_H)
+#define	TIMESYNC_H
+
+#include "StopWatch.h"
+
+const unsigned int TIME_SYNC_WINDOW  = 8U;
+const unsigned int TIME_SYNC_MINIMUM = 3U;
+
+// Estimates the offset of the local clock from the DAPNET core's using the
+// time sync exchanges. The core sends its time, in deciseconds modulo 65536,
+// in a '2' line, and follows our reply with a '3' line, which gives the round
+// trip time. As with NTP the offset is taken from the sample in the window
+// with the shortest round trip, as it has the least uncertainty.
+class CTimeSync {
+public:
+	CTimeSync();
+	~CTimeSync();
+
+	// Our time for the reply, in deciseconds modulo 65536
+	unsigned int request(unsigned int coreTime);
+	void         replied();
+	void         correction(int correction);
+
+	bool         isValid() const;
+
+	// In milliseconds, add to the local time to get the core's
+	int          getOffset() const;
+	unsigned int getRTT() const;
+	// In parts per million over the window, positive when the local clock is slow
+	int          getDrift() const;
+	int          getCorrection() const;
+
+private:
+	struct CTimeSample {
+		unsigned long long m_time;
+		int                m_offset;
+		unsigned int       m_rtt;
+	};
+
+	CTimeSample        m_samples[TIME_SYNC_WINDOW];
+	unsigned int       m_count;
+	unsigned int       m_next;
+	CStopWatch         m_clock;
+	CStopWatch         m_rttTimer;
+	bool               m_pending;
+	unsigned int       m_coreTime;
+	unsigned long long m_localTime;
+	bool               m_timing;
+	unsigned int       m_lastRTT;
+	int                m_correction;
+
+	void add(unsigned int rtt);
+	const CTimeSample* best() const;
+};
+
+#endif
@@ -0,0 +1,175 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "TimingThread.h"
+#include "DAPNETGateway.h"
+#include "Log.h"
+
+#include <cassert>
+#include <cstring>
+#include <cerrno>
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <sys/mman.h>
+#include <sched.h>
+#endif
+
+#if defined(_WIN32) || defined(_WIN64)
+
+CPriorityMutex::CPriorityMutex() :
+m_mutex()
+{
+}
+
+CPriorityMutex::~CPriorityMutex()
+{
+}
+
+void CPriorityMutex::lock()
+{
+	m_mutex.lock();
+}
+
+void CPriorityMutex::unlock()
+{
+	m_mutex.unlock();
+}
+
+#else
+
+CPriorityMutex::CPriorityMutex() :
+m_mutex()
+{
+	pthread_mutexattr_t attr;
+	::pthread_mutexattr_init(&attr);
+
+	// Without it the lock still works, but the timing thread can be held up
+	int err = ::pthread_mutexattr_setprotocol(&attr, PTHREAD_PRIO_INHERIT);
+	if (err != 0)
+		LogWarning("Unable to use priority inheritance for the timing lock, errno=%d", err);
+
+	::pthread_mutex_init(&m_mutex, &attr);
+	::pthread_mutexattr_destroy(&attr);
+}
+
+CPriorityMutex::~CPriorityMutex()
+{
+	::pthread_mutex_destroy(&m_mutex);
+}
+
+void CPriorityMutex::lock()
+{
+	::pthread_mutex_lock(&m_mutex);
+}
+
+void CPriorityMutex::unlock()
+{
+	::pthread_mutex_unlock(&m_mutex);
+}
+
+#endif
+
+CTimingThread::CTimingThread(CDAPNETGateway& gateway, CSlotClock& clock, unsigned int priority, int cpu, bool lockMemory) :
+CThread(),
+m_gateway(gateway),
+m_clock(clock),
+m_priority(priority),
+m_cpu(cpu),
+m_lockMemory(lockMemory),
+m_stopped(false)
+{
+}
+
+CTimingThread::~CTimingThread()
+{
+}
+
+bool CTimingThread::start()
+{
+	bool ret = run();
+	if (!ret) {
+		LogError("Unable to start the timing thread");
+		return false;
+	}
+
+	LogMessage("Slots and sending are on the timing thread");
+
+	return true;
+}
+
+void CTimingThread::entry()
+{
+	setRealTime();
+
+	while (!m_stopped.load(std::memory_order_relaxed)) {
+		m_gateway.timing();
+
+		m_clock.sleep(10U);
+	}
+}
+
+void CTimingThread::stop()
+{
+	m_stopped.store(true, std::memory_order_relaxed);
+
+	wait();
+}
+
+#if defined(_WIN32) || defined(_WIN64)
+
+void CTimingThread::setRealTime()
+{
+	if (!::SetThreadPriority(::GetCurrentThread(), THREAD_PRIORITY_TIME_CRITICAL))
+		LogWarning("Unable to raise the priority of the timing thread, error %lu", ::GetLastError());
+
+	if (m_cpu >= 0 && ::SetThreadAffinityMask(::GetCurrentThread(), DWORD_PTR(1) << m_cpu) == 0)
+		LogWarning("Unable to pin the timing thread to CPU %d, error %lu", m_cpu, ::GetLastError());
+}
+
+#else
+
+void CTimingThread::setRealTime()
+{
+	// Lock the memory first, so that page faults don't undo the rest
+	if (m_lockMemory && ::mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+		LogWarning("Unable to lock the memory, errno=%d", errno);
+
+#if defined(__linux__)
+	if (m_cpu >= 0) {
+		cpu_set_t cpus;
+		CPU_ZERO(&cpus);
+		CPU_SET(m_cpu, &cpus);
+
+		int err = ::pthread_setaffinity_np(::pthread_self(), sizeof(cpu_set_t), &cpus);
+		if (err != 0)
+			LogWarning("Unable to pin the timing thread to CPU %d, errno=%d", m_cpu, err);
+	}
+#endif
+
+	struct sched_param param;
+	::memset(&param, 0x00U, sizeof(struct sched_param));
+	param.sched_priority = int(m_priority);
+
+	int err = ::pthread_setschedparam(::pthread_self(), SCHED_FIFO, &param);
+	if (err != 0)
+		LogWarning("Unable to run the timing thread at SCHED_FIFO priority %u, errno=%d", m_priority, err);
+	else
+		LogMessage("The timing thread is running at SCHED_FIFO priority %u", m_priority);
+}
+
+#endif
@@ -0,0 +1,82 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(TIMINGTHREAD_H)
+#define	TIMINGTHREAD_H
+
+#include "SlotClock.h"
+#include "Thread.h"
+
+#include <atomic>
+
+#if defined(_WIN32) || defined(_WIN64)
+#include <mutex>
+#else
+#include <pthread.h>
+#endif
+
+class CDAPNETGateway;
+
+// The lock on the state that the timing thread shares with the main loop,
+// only held to hand it over. The holder inherits the priority of the timing
+// thread while it waits, so that a busy host can't keep it off the CPU with
+// the lock held. Windows has no priority inheritance, a plain mutex is used.
+class CPriorityMutex {
+public:
+	CPriorityMutex();
+	~CPriorityMutex();
+
+	void lock();
+	void unlock();
+
+private:
+#if defined(_WIN32) || defined(_WIN64)
+	std::mutex      m_mutex;
+#else
+	pthread_mutex_t m_mutex;
+#endif
+};
+
+// Runs the slot boundaries and the sending of messages, the parts of the
+// gateway where a late wakeup costs airtime, on a thread of their own. It
+// can be given a real time priority, pinned to a CPU, and have the process
+// memory locked, so that it isn't held up by the other services on a busy
+// host. Everything else stays on the main loop.
+class CTimingThread : public CThread {
+public:
+	CTimingThread(CDAPNETGateway& gateway, CSlotClock& clock, unsigned int priority, int cpu, bool lockMemory);
+	virtual ~CTimingThread();
+
+	bool start();
+
+	virtual void entry();
+
+	void stop();
+
+private:
+	CDAPNETGateway&   m_gateway;
+	CSlotClock&       m_clock;
+	unsigned int      m_priority;
+	int               m_cpu;
+	bool              m_lockMemory;
+	std::atomic<bool> m_stopped;
+
+	void setRealTime();
+};
+
+#endif
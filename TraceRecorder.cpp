@@ -0,0 +1,111 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "TraceRecorder.h"
+#include "Log.h"
+
+#include <cstdio>
+#include <cassert>
+#include <cerrno>
+
+static const char* TRACK_NAMES[] = {"", "Slots", "MMDVM", "Messages", "Network"};
+
+CTraceRecorder::CTraceRecorder() :
+m_events(),
+m_next(0U),
+m_count(0U)
+{
+}
+
+CTraceRecorder::~CTraceRecorder()
+{
+}
+
+void CTraceRecorder::open(unsigned int size)
+{
+	assert(size > 0U);
+
+	m_events.resize(size);
+	m_next  = 0U;
+	m_count = 0U;
+
+	LogMessage("Recording up to %u trace events", size);
+}
+
+bool CTraceRecorder::write(const std::string& fileName) const
+{
+	assert(!fileName.empty());
+
+	FILE* fp = ::fopen(fileName.c_str(), "wt");
+	if (fp == nullptr) {
+		LogError("Cannot open the trace file %s, err=%d", fileName.c_str(), errno);
+		return false;
+	}
+
+	::fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+	for (unsigned int i = (unsigned int)TRACE_TRACK::SLOTS; i <= (unsigned int)TRACE_TRACK::NETWORK; i++) {
+		::fprintf(fp, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"%s\"}},\n", i, TRACK_NAMES[i]);
+		::fprintf(fp, "{\"name\":\"thread_sort_index\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"sort_index\":%u}}%s\n", i, i, (m_count > 0U || i < (unsigned int)TRACE_TRACK::NETWORK) ? "," : "");
+	}
+
+	// Oldest first
+	unsigned int index = (m_count < m_events.size()) ? 0U : m_next;
+
+	for (unsigned int n = 0U; n < m_count; n++) {
+		const CTraceEvent& event = m_events[index];
+
+		::fprintf(fp, "{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%llu,", event.m_name, event.m_phase, (unsigned long long)event.m_time);
+
+		if (event.m_phase == 'X')
+			::fprintf(fp, "\"dur\":%u,", event.m_duration);
+		else
+			::fprintf(fp, "\"s\":\"t\",");
+
+		::fprintf(fp, "\"pid\":1,\"tid\":%u", (unsigned int)event.m_track);
+
+		if (event.m_argName != nullptr)
+			::fprintf(fp, ",\"args\":{\"%s\":%u}", event.m_argName, event.m_arg);
+
+		::fprintf(fp, "}%s\n", (n + 1U) < m_count ? "," : "");
+
+		index++;
+		if (index >= m_events.size())
+			index = 0U;
+	}
+
+	::fprintf(fp, "]}\n");
+
+	bool ok = ::ferror(fp) == 0;
+	::fclose(fp);
+
+	if (ok)
+		LogMessage("Written %u trace events to %s", m_count, fileName.c_str());
+	else
+		LogError("Error writing the trace file %s", fileName.c_str());
+
+	return ok;
+}
+
+void CTraceRecorder::close()
+{
+	m_events.clear();
+	m_events.shrink_to_fit();
+	m_next  = 0U;
+	m_count = 0U;
+}
@@ -0,0 +1,133 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(TRACERECORDER_H)
+#define	TRACERECORDER_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+enum class TRACE_TRACK : unsigned int {
+	SLOTS = 1U,
+	MMDVM,
+	MESSAGES,
+	NETWORK
+};
+
+// Records spans and instants into a ring of events that is allocated once at
+// startup, the oldest events are overwritten when it is full. The ring can be
+// written out as a Chrome trace-event JSON file for chrome://tracing or
+// Perfetto. The names must be string literals as only the pointers are kept.
+class CTraceRecorder {
+public:
+	CTraceRecorder();
+	~CTraceRecorder();
+
+	void open(unsigned int size);
+
+	bool isEnabled() const
+	{
+		return !m_events.empty();
+	}
+
+	// Microseconds on the monotonic clock
+	uint64_t now() const
+	{
+		if (m_events.empty())
+			return 0U;
+
+		return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	// A span from start until now, with an optional argument
+	void span(TRACE_TRACK track, const char* name, uint64_t start, const char* argName = nullptr, unsigned int arg = 0U)
+	{
+		if (m_events.empty())
+			return;
+
+		uint64_t end = now();
+		add(track, name, 'X', start, (unsigned int)(end - start), argName, arg);
+	}
+
+	void instant(TRACE_TRACK track, const char* name, const char* argName = nullptr, unsigned int arg = 0U)
+	{
+		if (m_events.empty())
+			return;
+
+		add(track, name, 'i', now(), 0U, argName, arg);
+	}
+
+	// The same for times taken on another thread and recorded later
+	void span(TRACE_TRACK track, const char* name, uint64_t start, uint64_t end, const char* argName, unsigned int arg)
+	{
+		if (m_events.empty())
+			return;
+
+		add(track, name, 'X', start, (unsigned int)(end - start), argName, arg);
+	}
+
+	void instant(TRACE_TRACK track, const char* name, uint64_t time, const char* argName, unsigned int arg)
+	{
+		if (m_events.empty())
+			return;
+
+		add(track, name, 'i', time, 0U, argName, arg);
+	}
+
+	bool write(const std::string& fileName) const;
+
+	void close();
+
+private:
+	struct CTraceEvent {
+		uint64_t     m_time;
+		unsigned int m_duration;
+		unsigned int m_arg;
+		const char*  m_name;
+		const char*  m_argName;
+		TRACE_TRACK  m_track;
+		char         m_phase;
+	};
+
+	std::vector<CTraceEvent> m_events;
+	unsigned int             m_next;
+	unsigned int             m_count;
+
+	void add(TRACE_TRACK track, const char* name, char phase, uint64_t time, unsigned int duration, const char* argName, unsigned int arg)
+	{
+		CTraceEvent& event = m_events[m_next];
+		event.m_time     = time;
+		event.m_duration = duration;
+		event.m_arg      = arg;
+		event.m_name     = name;
+		event.m_argName  = argName;
+		event.m_track    = track;
+		event.m_phase    = phase;
+
+		m_next++;
+		if (m_next >= m_events.size())
+			m_next = 0U;
+
+		if (m_count < m_events.size())
+			m_count++;
+	}
+};
+
+#endif
@@ -1,5 +1,5 @@
 /*
- *	Copyright (C) 2009,2014,2015,2016,2023,2025 Jonathan Naylor, G4KLX
+ *	Copyright (C) 2009,2014,2015,2016,2023,2025,2026 Jonathan Naylor, G4KLX
  *
  *	This program is free software; you can redistribute it and/or modify
  *	it under the terms of the GNU General Public License as published by
@@ -35,6 +35,9 @@ void CUtils::dump(int level, const std::string& title, const unsigned char* data
 {
 	assert(data != nullptr);
 
+	if (!::LogEnabled(level))
+		return;
+
 	::Log(level, "%s", title.c_str());
 
 	unsigned int offset = 0U;
@@ -0,0 +1,208 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#include "Watchdog.h"
+#include "MQTTConnection.h"
+#include "Utils.h"
+#include "Log.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstddef>
+#include <cassert>
+#include <cerrno>
+
+#if !defined(_WIN32) && !defined(_WIN64)
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+extern CMQTTConnection* m_mqtt;
+
+const unsigned int WATCHDOG_CHECK_MS = 100U;
+
+CWatchdog::CWatchdog(unsigned int threshold, bool systemd) :
+CThread(),
+m_threshold(threshold),
+m_systemd(systemd),
+m_beats(0U),
+m_stage((unsigned int)STAGE::MMDVM_READ),
+m_stageTime(now()),
+m_stopped(false),
+m_fd(-1),
+m_address(),
+m_interval(0U)
+{
+	assert(threshold > 0U);
+}
+
+CWatchdog::~CWatchdog()
+{
+}
+
+bool CWatchdog::start()
+{
+	if (m_systemd)
+		openSystemd();
+
+	bool ret = run();
+	if (!ret) {
+		LogError("Unable to start the watchdog thread");
+		return false;
+	}
+
+	LogMessage("Watching for main loop stalls of over %u ms", m_threshold);
+
+	return true;
+}
+
+void CWatchdog::entry()
+{
+	notify("READY=1");
+
+	unsigned int lastBeats = m_beats.load(std::memory_order_relaxed);
+	uint64_t lastBeatTime  = now();
+	uint64_t lastNotify    = lastBeatTime;
+	bool stalled = false;
+
+	while (!m_stopped.load(std::memory_order_relaxed)) {
+		CThread::sleep(WATCHDOG_CHECK_MS);
+
+		uint64_t time = now();
+		unsigned int beats = m_beats.load(std::memory_order_relaxed);
+
+		if (beats != lastBeats) {
+			if (stalled) {
+				alert("recovered", STAGE(m_stage.load(std::memory_order_relaxed)), (unsigned int)(time - lastBeatTime), 0U);
+				stalled = false;
+			}
+
+			lastBeats    = beats;
+			lastBeatTime = time;
+
+			// Only tell systemd that we're alive while the main loop is
+			if (m_interval > 0U && (time - lastNotify) >= m_interval) {
+				notify("WATCHDOG=1");
+				lastNotify = time;
+			}
+		} else if (!stalled && (time - lastBeatTime) >= m_threshold) {
+			STAGE stage = STAGE(m_stage.load(std::memory_order_relaxed));
+			uint64_t stageTime = m_stageTime.load(std::memory_order_relaxed);
+
+			alert("stalled", stage, (unsigned int)(time - lastBeatTime), (unsigned int)(time - stageTime));
+			stalled = true;
+		}
+	}
+
+	notify("STOPPING=1");
+
+#if !defined(_WIN32) && !defined(_WIN64)
+	if (m_fd != -1) {
+		::close(m_fd);
+		m_fd = -1;
+	}
+#endif
+}
+
+void CWatchdog::stop()
+{
+	m_stopped.store(true, std::memory_order_relaxed);
+
+	wait();
+}
+
+void CWatchdog::alert(const char* event, STAGE stage, unsigned int stalled, unsigned int stageTime) const
+{
+	assert(event != nullptr);
+
+	// Not the normal logging, in case it is what has blocked
+	if (stageTime > 0U)
+		::fprintf(stderr, "Watchdog: main loop %s for %u ms, in the %s stage for %u ms\n", event, stalled, ::StageName(stage), stageTime);
+	else
+		::fprintf(stderr, "Watchdog: main loop %s after %u ms\n", event, stalled);
+
+	if (m_mqtt == nullptr)
+		return;
+
+	char text[300U];
+	::snprintf(text, 300U, "{\"watchdog\":{\"timestamp\":\"%s\",\"event\":\"%s\",\"stage\":\"%s\",\"stalled\":%u,\"stage_time\":%u}}",
+		CUtils::createTimestamp().c_str(), event, ::StageName(stage), stalled, stageTime);
+
+	m_mqtt->publishNow("json", text);
+}
+
+void CWatchdog::openSystemd()
+{
+#if defined(_WIN32) || defined(_WIN64)
+	LogWarning("The systemd watchdog is not supported on Windows");
+#else
+	const char* address = ::getenv("NOTIFY_SOCKET");
+	if (address == nullptr || (address[0U] != '/' && address[0U] != '@')) {
+		LogWarning("NOTIFY_SOCKET is not set, not running under systemd");
+		return;
+	}
+
+	m_address = address;
+
+	// An abstract socket
+	if (m_address[0U] == '@')
+		m_address[0U] = '\0';
+
+	if (m_address.size() >= sizeof(((struct sockaddr_un*)nullptr)->sun_path)) {
+		LogError("NOTIFY_SOCKET is too long");
+		return;
+	}
+
+	m_fd = ::socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+	if (m_fd == -1) {
+		LogError("Cannot open the systemd notify socket, err=%d", errno);
+		return;
+	}
+
+	// Ping at half of the interval that systemd expects
+	const char* usec = ::getenv("WATCHDOG_USEC");
+	if (usec != nullptr)
+		m_interval = (unsigned int)(::strtoull(usec, nullptr, 10) / 2000ULL);
+
+	if (m_interval > 0U)
+		LogMessage("Notifying the systemd watchdog every %u ms", m_interval);
+	else
+		LogMessage("WatchdogSec is not set for this service, only notifying systemd of readiness");
+#endif
+}
+
+void CWatchdog::notify(const char* state) const
+{
+	assert(state != nullptr);
+
+#if !defined(_WIN32) && !defined(_WIN64)
+	if (m_fd == -1)
+		return;
+
+	struct sockaddr_un addr;
+	::memset(&addr, 0x00U, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	::memcpy(addr.sun_path, m_address.c_str(), m_address.size());
+
+	socklen_t length = socklen_t(offsetof(struct sockaddr_un, sun_path) + m_address.size());
+
+	::sendto(m_fd, state, ::strlen(state), MSG_NOSIGNAL, (struct sockaddr*)&addr, length);
+#endif
+}
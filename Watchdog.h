@@ -0,0 +1,79 @@
+/*
+ *   Copyright (C) 2026 by Jonathan Naylor G4KLX
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation; either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 675 Mass Ave, Cambridge, MA 02139, USA.
+ */
+
+#if !defined(WATCHDOG_H)
+#define	WATCHDOG_H
+
+#include "StageProfiler.h"
+#include "Thread.h"
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <cstdint>
+
+// Watches for the main loop stalling. The loop bumps a heartbeat on every pass
+// and records the stage that it is in, both are relaxed atomic stores. If the
+// heartbeat stops for longer than the threshold the stage and how long it has
+// been running are written to stderr and published as a JSON record directly
+// to the broker. It can also keep the systemd watchdog happy while the loop
+// is running, so that systemd restarts a gateway that has hung.
+class CWatchdog : public CThread {
+public:
+	CWatchdog(unsigned int threshold, bool systemd);
+	virtual ~CWatchdog();
+
+	bool start();
+
+	void beat()
+	{
+		m_beats.fetch_add(1U, std::memory_order_relaxed);
+	}
+
+	void enter(STAGE stage)
+	{
+		m_stage.store((unsigned int)stage, std::memory_order_relaxed);
+		m_stageTime.store(now(), std::memory_order_relaxed);
+	}
+
+	virtual void entry();
+
+	void stop();
+
+private:
+	unsigned int               m_threshold;
+	bool                       m_systemd;
+	std::atomic<unsigned int>  m_beats;
+	std::atomic<unsigned int>  m_stage;
+	std::atomic<uint64_t>      m_stageTime;
+	std::atomic<bool>          m_stopped;
+	int                        m_fd;
+	std::string                m_address;
+	unsigned int               m_interval;
+
+	static uint64_t now()
+	{
+		return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	void alert(const char* event, STAGE stage, unsigned int stalled, unsigned int stageTime) const;
+	void openSystemd();
+	void notify(const char* state) const;
+};
+
+#endif